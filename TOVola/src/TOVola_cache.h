@@ -0,0 +1,214 @@
+#pragma once
+
+//This header file holds the dimensionless scaling cache of Simple polytropes. With G=c=1, P = K rho^Gamma has the length unit
+//L = K^{1/(2(Gamma-1))}, and every star is the K=1 star of central density L^2 rho_c = K^{1/(Gamma-1)} rho_c, rescaled.
+//The raw profile is therefore solved once for K=1, stored under (Gamma, L^2 rho_c) in TOVola_scaling_cache_dir, and
+//rescaled analytically to the K of the run on every load. Each cached star is one binary file in native byte order,
+//which also records the solver settings it was integrated with; a file with other settings is solved again and replaced.
+
+#include "GRHayLib.h"
+#include "TOVola_defines.h"
+#include "TOVola_solve.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <cctk.h>
+#include <cctk_Parameters.h>
+
+#define TOVOLA_CACHE_MAGIC "TOVolaS1"
+
+/* Header of a cache file, followed by the raw arrays (and their derivatives, if store_derivatives) of numpoints samples */
+typedef struct {
+  char magic[8];
+  // Key
+  CCTK_REAL Gamma;
+  CCTK_REAL rho_bar_c;
+  // Solver settings of the profile
+  CCTK_REAL error_limit;
+  CCTK_REAL initial_ode_step_size;
+  CCTK_REAL absolute_min_step;
+  CCTK_REAL absolute_max_step;
+  int ode_method_ADP8;
+  int max_steps;
+  int store_derivatives;
+  int observables;
+  int sensitivities;
+  // Dimensionless solution
+  int numpoints;
+  long num_rhs_evaluations;
+  CCTK_REAL baryon_mass;
+  CCTK_REAL moment_of_inertia;
+  CCTK_REAL love_k2;
+  CCTK_REAL dmass_drho_c;
+  CCTK_REAL dradius_drho_c;
+} TOVola_cache_header_struct;
+
+//Key and solver settings of the K=1 star; the solution fields are filled after the solve or by the load.
+static void TOVola_cache_header(TOVola_cache_header_struct *restrict header, const TOVola_data_struct *restrict TOVdata,
+                                const char *ode_method, const int max_steps, const CCTK_REAL Gamma, const CCTK_REAL rho_bar_c){
+  memset(header, 0, sizeof(*header)); // Padding too, so that equal settings compare equal
+  memcpy(header->magic, TOVOLA_CACHE_MAGIC, sizeof(header->magic));
+  header->Gamma = Gamma;
+  header->rho_bar_c = rho_bar_c;
+  header->error_limit = TOVdata->error_limit;
+  header->initial_ode_step_size = TOVdata->initial_ode_step_size;
+  header->absolute_min_step = TOVdata->absolute_min_step;
+  header->absolute_max_step = TOVdata->absolute_max_step;
+  header->ode_method_ADP8 = CCTK_EQUALS(ode_method, "ADP8");
+  header->max_steps = max_steps;
+  header->store_derivatives = TOVdata->store_derivatives;
+  header->observables = TOVdata->observables;
+  header->sensitivities = TOVdata->sensitivities;
+}
+
+//Round rho_bar_c to the 12 digits of the key. The same dimensionless star reached through different K and rho_c then has the same
+//key despite roundoff, and it is the star of this rounded value that is integrated; the change is far below the integration error.
+static CCTK_REAL TOVola_cache_key(const CCTK_REAL rho_bar_c){
+  char digits[32];
+  snprintf(digits, sizeof(digits), "%.11e", rho_bar_c);
+  return strtod(digits, NULL);
+}
+
+//Path of the cache file of a key
+static void TOVola_cache_path(char *restrict path, const size_t len, const char *dir, const CCTK_REAL Gamma, const CCTK_REAL rho_bar_c){
+  snprintf(path, len, "%s/TOVola_Gamma%.15g_rhoc%.11e.bin", dir, Gamma, rho_bar_c);
+}
+
+//The raw arrays of TOVdata that are stored, in file order
+static int TOVola_cache_arrays(TOVola_data_struct *restrict TOVdata, CCTK_REAL *arrays[11]){
+  arrays[0] = TOVdata->rSchw_arr;
+  arrays[1] = TOVdata->rho_energy_arr;
+  arrays[2] = TOVdata->rho_baryon_arr;
+  arrays[3] = TOVdata->P_arr;
+  arrays[4] = TOVdata->M_arr;
+  arrays[5] = TOVdata->nu_arr;
+  arrays[6] = TOVdata->Iso_r_arr;
+  if (!TOVdata->store_derivatives) return 7;
+  arrays[7] = TOVdata->dPdr_arr;
+  arrays[8] = TOVdata->dnudr_arr;
+  arrays[9] = TOVdata->dMdr_arr;
+  arrays[10] = TOVdata->dIso_rdr_arr;
+  return 11;
+}
+
+//Read the dimensionless star of the key and settings in *expected into TOVdata. Returns 0 on success, nonzero if there is
+//no usable file.
+static int TOVola_cache_load(const char *path, const TOVola_cache_header_struct *restrict expected, TOVola_data_struct *restrict TOVdata){
+  FILE *file = fopen(path, "rb");
+  if (!file) return 1;
+  TOVola_cache_header_struct header;
+  memset(&header, 0, sizeof(header));
+  if (fread(&header, sizeof(header), 1, file) != 1 || header.numpoints <= 0
+      || memcmp(&header, expected, offsetof(TOVola_cache_header_struct, numpoints)) != 0) {
+    fclose(file);
+    return 1;
+  }
+  TOVola_reserve(TOVdata, header.numpoints);
+  CCTK_REAL *arrays[11];
+  const int num_arrays = TOVola_cache_arrays(TOVdata, arrays);
+  for(int a=0; a<num_arrays; a++){
+    if (fread(arrays[a], sizeof(CCTK_REAL), header.numpoints, file) != (size_t)header.numpoints) {
+      fclose(file);
+      return 1;
+    }
+  }
+  fclose(file);
+  TOVdata->numpoints_actually_saved = header.numpoints;
+  TOVdata->num_rhs_evaluations = header.num_rhs_evaluations;
+  TOVdata->baryon_mass = header.baryon_mass;
+  TOVdata->moment_of_inertia = header.moment_of_inertia;
+  TOVdata->love_k2 = header.love_k2;
+  TOVdata->dmass_drho_c = header.dmass_drho_c;
+  TOVdata->dradius_drho_c = header.dradius_drho_c;
+  return 0;
+}
+
+//Store the dimensionless star in TOVdata. The file is written under a temporary name and renamed, so that concurrent runs
+//never read a partial file. Problems are reported, not fatal.
+static void TOVola_cache_save(const char *path, const char *dir, TOVola_cache_header_struct *restrict header, TOVola_data_struct *restrict TOVdata){
+  header->numpoints = TOVdata->numpoints_actually_saved;
+  header->num_rhs_evaluations = TOVdata->num_rhs_evaluations;
+  header->baryon_mass = TOVdata->baryon_mass;
+  header->moment_of_inertia = TOVdata->moment_of_inertia;
+  header->love_k2 = TOVdata->love_k2;
+  header->dmass_drho_c = TOVdata->dmass_drho_c;
+  header->dradius_drho_c = TOVdata->dradius_drho_c;
+
+  char tmp_path[4096 + 32];
+  snprintf(tmp_path, sizeof(tmp_path), "%s.tmp%d", path, CCTK_MyProc(NULL));
+  CCTK_CreateDirectory(0755, dir);
+  FILE *file = fopen(tmp_path, "wb");
+  if (!file) {
+    CCTK_VWARN(CCTK_WARN_ALERT, "Could not write the TOVola scaling cache file '%s'.", tmp_path);
+    return;
+  }
+  CCTK_REAL *arrays[11];
+  const int num_arrays = TOVola_cache_arrays(TOVdata, arrays);
+  int ok = fwrite(header, sizeof(*header), 1, file) == 1;
+  for(int a=0; a<num_arrays; a++)
+    ok = ok && fwrite(arrays[a], sizeof(CCTK_REAL), header->numpoints, file) == (size_t)header->numpoints;
+  ok = (fclose(file) == 0) && ok;
+  if (!ok || rename(tmp_path, path) != 0) {
+    CCTK_VWARN(CCTK_WARN_ALERT, "Could not write the TOVola scaling cache file '%s'.", path);
+    remove(tmp_path);
+  }
+}
+
+//Rescale the dimensionless raw star in TOVdata to the length unit L: lengths and masses by L, densities and pressure by 1/L^2
+static void TOVola_rescale(TOVola_data_struct *restrict TOVdata, const CCTK_REAL L){
+  const CCTK_REAL inv_L2 = 1.0 / (L * L);
+  for(int i=0; i<TOVdata->numpoints_actually_saved; i++){
+    TOVdata->rSchw_arr[i] *= L;
+    TOVdata->rho_energy_arr[i] *= inv_L2;
+    TOVdata->rho_baryon_arr[i] *= inv_L2;
+    TOVdata->P_arr[i] *= inv_L2;
+    TOVdata->M_arr[i] *= L;
+    TOVdata->Iso_r_arr[i] *= L;
+  }
+  if (TOVdata->store_derivatives) {
+    // dM/dr and dr_iso/dr are dimensionless
+    for(int i=0; i<TOVdata->numpoints_actually_saved; i++){
+      TOVdata->dPdr_arr[i] *= inv_L2 / L;
+      TOVdata->dnudr_arr[i] /= L;
+    }
+  }
+  TOVdata->baryon_mass *= L;
+  TOVdata->moment_of_inertia *= L * L * L;
+  TOVdata->dmass_drho_c *= L * L * L;
+  TOVdata->dradius_drho_c *= L * L * L;
+}
+
+//TOVola_integrate for a Simple polytrope, through the scaling cache in dir: the K=1 star is loaded, or else solved and stored,
+//and then rescaled to the K of TOVdata->ghl_eos.
+static void TOVola_cached_integrate(TOVola_data_struct *TOVdata, const char *ode_method, const int max_steps, const char *dir){
+  const CCTK_REAL rho_c = TOVdata->central_baryon_density;
+  CCTK_REAL K, Gamma;
+  ghl_hybrid_get_K_and_Gamma(TOVdata->ghl_eos, rho_c, &K, &Gamma);
+  const CCTK_REAL L = pow(K, 0.5 / (Gamma - 1.0));
+  const CCTK_REAL rho_bar_c = TOVola_cache_key(rho_c * L * L);
+
+  TOVola_cache_header_struct header;
+  TOVola_cache_header(&header, TOVdata, ode_method, max_steps, Gamma, rho_bar_c);
+  char path[4096];
+  TOVola_cache_path(path, sizeof(path), dir, Gamma, rho_bar_c);
+
+  if (TOVola_cache_load(path, &header, TOVdata) == 0) {
+    CCTK_VINFO("Loaded the Gamma = %.6e, K^{1/(Gamma-1)} rho_c = %.11e star from the scaling cache '%s'.", Gamma, rho_bar_c, path);
+  }
+  else {
+    // Integrate the same star for K = 1
+    ghl_eos_parameters unit_eos = *TOVdata->ghl_eos;
+    unit_eos.K_ppoly[0] = 1.0;
+    ghl_eos_parameters *restrict eos = TOVdata->ghl_eos;
+    TOVdata->ghl_eos = &unit_eos;
+    TOVdata->central_baryon_density = rho_bar_c;
+    TOVola_integrate(TOVdata, ode_method, max_steps);
+    TOVdata->ghl_eos = eos;
+    TOVdata->central_baryon_density = rho_c;
+    if (CCTK_MyProc(NULL) == 0) TOVola_cache_save(path, dir, &header, TOVdata);
+  }
+  TOVola_rescale(TOVdata, L);
+}
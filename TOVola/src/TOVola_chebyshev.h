@@ -0,0 +1,183 @@
+#pragma once
+
+//This header file holds the piecewise Chebyshev representation of the normalized TOV profile.
+//The grid fields are fitted once on a few radial subdomains, and grid placement evaluates them with Clenshaw recursion.
+
+#include "TOVola_defines.h"
+#include "TOVola_interp.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <cctk.h>
+#include <cctk_Arguments.h>
+#include <cctk_Parameters.h>
+
+#define TOVOLA_CHEB_MAX_DOMAINS 64
+#define TOVOLA_CHEB_NUM_CHECKS 128
+
+/* Evaluate all grid fields at rr_iso (inside the star) with Clenshaw recursion */
+static inline void TOVola_Chebyshev_eval(const TOVola_Chebyshev_struct *restrict cheb, const CCTK_REAL rr_iso, CCTK_REAL *restrict out) {
+  // Locate the subdomain; there are only a handful, so bisect the edges.
+  int lo = 0, hi = cheb->num_domains;
+  while (hi - lo > 1) {
+    const int mid = (lo + hi) / 2;
+    if (rr_iso < cheb->r_edges[mid]) hi = mid;
+    else lo = mid;
+  }
+  const CCTK_REAL a = cheb->r_edges[lo];
+  const CCTK_REAL b = cheb->r_edges[lo + 1];
+  const CCTK_REAL t = (2.0 * rr_iso - (a + b)) / (b - a);
+  const int n = cheb->order[lo];
+  const CCTK_REAL *restrict c = &cheb->coeffs[lo * TOVOLA_NUM_GRID_FIELDS * cheb->max_order];
+
+  CCTK_REAL b1[TOVOLA_NUM_GRID_FIELDS] = {0.0};
+  CCTK_REAL b2[TOVOLA_NUM_GRID_FIELDS] = {0.0};
+  for (int j = n - 1; j >= 1; j--) {
+    for (int f = 0; f < TOVOLA_NUM_GRID_FIELDS; f++) {
+      const CCTK_REAL b0 = 2.0 * t * b1[f] - b2[f] + c[f * cheb->max_order + j];
+      b2[f] = b1[f];
+      b1[f] = b0;
+    }
+  }
+  for (int f = 0; f < TOVOLA_NUM_GRID_FIELDS; f++) {
+    out[f] = t * b1[f] - b2[f] + c[f * cheb->max_order];
+  }
+  // Densities and pressure vanish at the surface; do not let the series undershoot.
+  out[TOVOLA_GRID_RHO_ENERGY] = MAX(out[TOVOLA_GRID_RHO_ENERGY], 0.0);
+  out[TOVOLA_GRID_RHO_BARYON] = MAX(out[TOVOLA_GRID_RHO_BARYON], 0.0);
+  out[TOVOLA_GRID_P] = MAX(out[TOVOLA_GRID_P], 0.0);
+}
+
+/* Fit one subdomain [a,b] from the Lagrange interpolant of the raw profile at Chebyshev-Gauss nodes, drop the
+   negligible tail, and return the worst error relative to each field's scale, measured at profile knots in [a,b]. */
+static CCTK_REAL TOVola_Chebyshev_fit_domain(const TOVola_ID_persist_struct *restrict TOVola_ID_persist, const CCTK_REAL a, const CCTK_REAL b,
+                                             const int max_order, const CCTK_REAL tolerance, const CCTK_REAL *restrict scale,
+                                             const int Interpolation_Stencil, const int Max_Interpolation_Stencil,
+                                             CCTK_REAL *restrict coeffs, int *restrict order) {
+  const int N = max_order;
+  CCTK_REAL samples[TOVOLA_NUM_GRID_FIELDS][N];
+  for (int k = 0; k < N; k++) {
+    const CCTK_REAL r = 0.5 * (a + b) + 0.5 * (b - a) * cos(M_PI * (k + 0.5) / N);
+    CCTK_REAL M;
+    TOVola_TOV_interpolate_1D(r, Interpolation_Stencil, Max_Interpolation_Stencil, TOVola_ID_persist->numpoints_arr, TOVola_ID_persist->r_Schw_arr,
+                              TOVola_ID_persist->rho_energy_arr, TOVola_ID_persist->rho_baryon_arr, TOVola_ID_persist->P_arr, TOVola_ID_persist->M_arr,
+                              TOVola_ID_persist->expnu_arr, TOVola_ID_persist->exp4phi_arr, TOVola_ID_persist->r_iso_arr,
+                              &samples[TOVOLA_GRID_RHO_ENERGY][k], &samples[TOVOLA_GRID_RHO_BARYON][k], &samples[TOVOLA_GRID_P][k], &M,
+                              &samples[TOVOLA_GRID_EXPNU][k], &samples[TOVOLA_GRID_EXP4PHI][k]);
+  }
+
+  *order = 1;
+  for (int f = 0; f < TOVOLA_NUM_GRID_FIELDS; f++) {
+    for (int j = 0; j < N; j++) {
+      CCTK_REAL sum = 0.0;
+      for (int k = 0; k < N; k++) {
+        sum += samples[f][k] * cos(M_PI * j * (k + 0.5) / N);
+      }
+      coeffs[f * max_order + j] = (j == 0 ? 1.0 : 2.0) * sum / N;
+      if (fabs(coeffs[f * max_order + j]) > 0.1 * tolerance * scale[f]) {
+        *order = MAX(*order, j + 1);
+      }
+    }
+  }
+
+  // Error check against the raw profile itself, not just the coefficient tail.
+  TOVola_Chebyshev_struct one = {1, max_order, NULL, order, coeffs};
+  CCTK_REAL edges[2] = {a, b};
+  one.r_edges = edges;
+  const CCTK_REAL *restrict r_iso_arr = TOVola_ID_persist->r_iso_arr;
+  int ilo = NEGATIVE_R_INTERP_BUFFER;
+  while (ilo < TOVola_ID_persist->numpoints_arr && r_iso_arr[ilo] < a) ilo++;
+  int ihi = ilo;
+  while (ihi < TOVola_ID_persist->numpoints_arr && r_iso_arr[ihi] <= b) ihi++;
+  const int stride = MAX(1, (ihi - ilo) / TOVOLA_CHEB_NUM_CHECKS);
+  CCTK_REAL max_err = 0.0;
+  for (int i = ilo; i < ihi; i += stride) {
+    CCTK_REAL val[TOVOLA_NUM_GRID_FIELDS];
+    const CCTK_REAL truth[TOVOLA_NUM_GRID_FIELDS] = {TOVola_ID_persist->rho_energy_arr[i], TOVola_ID_persist->rho_baryon_arr[i], TOVola_ID_persist->P_arr[i],
+                                                     TOVola_ID_persist->expnu_arr[i], TOVola_ID_persist->exp4phi_arr[i]};
+    TOVola_Chebyshev_eval(&one, r_iso_arr[i], val);
+    for (int f = 0; f < TOVOLA_NUM_GRID_FIELDS; f++) {
+      max_err = MAX(max_err, fabs(val[f] - truth[f]) / scale[f]);
+    }
+  }
+  return max_err;
+}
+
+/* Fit the normalized profile on core, mantle and surface-layer subdomains, bisecting any subdomain
+   that misses the tolerance at the maximum order. */
+static int TOVola_Chebyshev_fit(TOVola_ID_persist_struct *restrict TOVola_ID_persist, const CCTK_REAL tolerance, const int max_order,
+                                const int Interpolation_Stencil, const int Max_Interpolation_Stencil) {
+  const int numpoints = TOVola_ID_persist->numpoints_arr;
+  const CCTK_REAL R_iso = TOVola_ID_persist->r_iso_arr[numpoints - 1];
+
+  // Field scales for the relative tolerance
+  CCTK_REAL scale[TOVOLA_NUM_GRID_FIELDS] = {0.0};
+  for (int i = NEGATIVE_R_INTERP_BUFFER; i < numpoints; i++) {
+    scale[TOVOLA_GRID_RHO_ENERGY] = MAX(scale[TOVOLA_GRID_RHO_ENERGY], fabs(TOVola_ID_persist->rho_energy_arr[i]));
+    scale[TOVOLA_GRID_RHO_BARYON] = MAX(scale[TOVOLA_GRID_RHO_BARYON], fabs(TOVola_ID_persist->rho_baryon_arr[i]));
+    scale[TOVOLA_GRID_P] = MAX(scale[TOVOLA_GRID_P], fabs(TOVola_ID_persist->P_arr[i]));
+    scale[TOVOLA_GRID_EXPNU] = MAX(scale[TOVOLA_GRID_EXPNU], fabs(TOVola_ID_persist->expnu_arr[i]));
+    scale[TOVOLA_GRID_EXP4PHI] = MAX(scale[TOVOLA_GRID_EXP4PHI], fabs(TOVola_ID_persist->exp4phi_arr[i]));
+  }
+  for (int f = 0; f < TOVOLA_NUM_GRID_FIELDS; f++) {
+    if (scale[f] == 0.0) scale[f] = 1.0;
+  }
+
+  // Initial subdomains: core down to half the central density, mantle down to the 5% layer the integrator resolves finely, surface layer.
+  CCTK_REAL edges[TOVOLA_CHEB_MAX_DOMAINS + 1];
+  int num_domains = 0;
+  edges[0] = 0.0;
+  const CCTK_REAL rho_c = scale[TOVOLA_GRID_RHO_BARYON];
+  const CCTK_REAL layer_fraction[2] = {0.5, 0.05};
+  int i = NEGATIVE_R_INTERP_BUFFER;
+  for (int l = 0; l < 2; l++) {
+    while (i < numpoints - 1 && TOVola_ID_persist->rho_baryon_arr[i] > layer_fraction[l] * rho_c) i++;
+    if (i < numpoints - 1 && TOVola_ID_persist->r_iso_arr[i] > edges[num_domains]) {
+      edges[++num_domains] = TOVola_ID_persist->r_iso_arr[i];
+    }
+  }
+  edges[++num_domains] = R_iso;
+
+  CCTK_REAL *restrict coeffs = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * TOVOLA_CHEB_MAX_DOMAINS * TOVOLA_NUM_GRID_FIELDS * max_order);
+  int order[TOVOLA_CHEB_MAX_DOMAINS];
+  if (!coeffs) {
+    return -1;
+  }
+
+  CCTK_REAL worst_err = 0.0;
+  for (int d = 0; d < num_domains; d++) {
+    CCTK_REAL err = TOVola_Chebyshev_fit_domain(TOVola_ID_persist, edges[d], edges[d + 1], max_order, tolerance, scale, Interpolation_Stencil,
+                                                Max_Interpolation_Stencil, &coeffs[d * TOVOLA_NUM_GRID_FIELDS * max_order], &order[d]);
+    if (err > tolerance && num_domains < TOVOLA_CHEB_MAX_DOMAINS) {
+      // Split and retry the left half; the right half is fitted on the next pass.
+      for (int e = num_domains; e > d; e--) edges[e + 1] = edges[e];
+      edges[d + 1] = 0.5 * (edges[d] + edges[d + 2]);
+      num_domains++;
+      d--;
+      continue;
+    }
+    worst_err = MAX(worst_err, err);
+  }
+  if (worst_err > tolerance) {
+    CCTK_VWARN(CCTK_WARN_ALERT, "TOVola Chebyshev fit reached %d subdomains with relative error %e > tolerance %e.", num_domains, worst_err, tolerance);
+  }
+
+  TOVola_Chebyshev_struct *restrict cheb = &TOVola_ID_persist->cheb;
+  cheb->num_domains = num_domains;
+  cheb->max_order = max_order;
+  cheb->r_edges = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * (num_domains + 1));
+  cheb->order = (int *restrict)malloc(sizeof(int) * num_domains);
+  cheb->coeffs = (CCTK_REAL *restrict)realloc(coeffs, sizeof(CCTK_REAL) * num_domains * TOVOLA_NUM_GRID_FIELDS * max_order);
+  if (!cheb->r_edges || !cheb->order || !cheb->coeffs) {
+    return -1;
+  }
+  memcpy(cheb->r_edges, edges, sizeof(CCTK_REAL) * (num_domains + 1));
+  memcpy(cheb->order, order, sizeof(int) * num_domains);
+
+  int total_coeffs = 0;
+  for (int d = 0; d < num_domains; d++) total_coeffs += order[d];
+  CCTK_VINFO("Chebyshev profile: %d subdomains, %d coefficients per field, max relative error %.3e.", num_domains, total_coeffs, worst_err);
+  return 0;
+}
@@ -4,6 +4,39 @@
 #include <cctk_Arguments.h>
 #include <cctk_Parameters.h>
 
+/* Interleaved profile knot: only the fields that end up on the grid, so that one stencil
+   gather touches one contiguous record per knot instead of one cache line per array. */
+typedef struct {
+        CCTK_REAL r_iso;
+        CCTK_REAL rho_energy;
+        CCTK_REAL rho_baryon;
+        CCTK_REAL P;
+        CCTK_REAL expnu;
+        CCTK_REAL exp4phi;
+} TOVola_knot_struct;
+
+/* Interpolation methods from the normalized profile to the grid */
+#define TOVOLA_INTERP_LAGRANGE 0
+#define TOVOLA_INTERP_CHEBYSHEV 1
+#define TOVOLA_INTERP_HERMITE 2
+
+/* Fields carried to the grid, in the order used by the fitted representations */
+#define TOVOLA_NUM_GRID_FIELDS 5
+#define TOVOLA_GRID_RHO_ENERGY 0
+#define TOVOLA_GRID_RHO_BARYON 1
+#define TOVOLA_GRID_P 2
+#define TOVOLA_GRID_EXPNU 3
+#define TOVOLA_GRID_EXP4PHI 4
+
+/* Piecewise Chebyshev fit of the grid fields over r_iso in [0, R_iso] */
+typedef struct {
+        int num_domains;
+        int max_order;
+        CCTK_REAL *restrict r_edges;  // num_domains+1 subdomain edges in r_iso
+        int *restrict order;          // Coefficients kept per subdomain
+        CCTK_REAL *restrict coeffs;   // [domain][field][max_order], c_0 already halved
+} TOVola_Chebyshev_struct;
+
 /* Structure to hold TOV data that will become the official ID after normalization */
 typedef struct {
         CCTK_REAL *restrict r_Schw_arr;
@@ -14,5 +47,147 @@ typedef struct {
         CCTK_REAL *restrict expnu_arr;
         CCTK_REAL *restrict r_iso_arr;
         CCTK_REAL *restrict exp4phi_arr;
+        CCTK_REAL *restrict drho_energy_arr; // d/dr_iso of the grid fields, only for Hermite interpolation (else NULL)
+        CCTK_REAL *restrict drho_baryon_arr;
+        CCTK_REAL *restrict dP_arr;
+        CCTK_REAL *restrict dexpnu_arr;
+        CCTK_REAL *restrict dexp4phi_arr;
+        unsigned char *restrict stencil_arr; // Per-knot adaptive Lagrange stencil size, NULL for the fixed stencil
+        TOVola_knot_struct *restrict knots; // Interleaved copy for batched interpolation, NULL if unused
+        TOVola_Chebyshev_struct cheb;       // Spectral fit, empty unless interp_method is Chebyshev
+        CCTK_REAL baryon_mass;              // Total baryon mass, integrated over the profile
+        CCTK_REAL moment_of_inertia;        // Slow-rotation moment of inertia and Love number k2, only with TOVola_observables
+        CCTK_REAL love_k2;
+        int interp_method;
         int numpoints_arr;
 } TOVola_ID_persist_struct;
+
+/* Past timelevels of the evolved fields. Lapse, shift, curvature and pressure have no past levels to fill.
+   The composition fields are NULL unless TOVola provides them, as in TOVola_gf_struct. */
+#define TOVOLA_MAX_PAST_LEVELS 2
+typedef struct {
+        CCTK_REAL *restrict rho;
+        CCTK_REAL *restrict eps;
+        CCTK_REAL *restrict gxx;
+        CCTK_REAL *restrict gyy;
+        CCTK_REAL *restrict gzz;
+        CCTK_REAL *restrict gxy;
+        CCTK_REAL *restrict gxz;
+        CCTK_REAL *restrict gyz;
+        CCTK_REAL *restrict vel_x;
+        CCTK_REAL *restrict vel_y;
+        CCTK_REAL *restrict vel_z;
+        CCTK_REAL *restrict w_lorentz;
+        CCTK_REAL *restrict Y_e;
+        CCTK_REAL *restrict temperature;
+        CCTK_REAL *restrict entropy;
+} TOVola_past_gf_struct;
+
+/* Beta-equilibrium slice of a tabulated EOS at TOVola_Tin, sampled at the table densities.
+   The log(rho) and Y_e samples belong to GRHayL; the entropy is computed once per solve. */
+typedef struct {
+        int N_rho;
+        const CCTK_REAL *restrict logrho;
+        const CCTK_REAL *restrict Ye_of_lr;
+        CCTK_REAL *restrict S_of_lr;
+        CCTK_REAL T;
+} TOVola_beq_struct;
+
+/* Grid functions written by TOVola. vel_x etc. avoid the velx macros of the driver. */
+typedef struct {
+        CCTK_REAL *restrict rho;
+        CCTK_REAL *restrict press;
+        CCTK_REAL *restrict eps;
+        CCTK_REAL *restrict alp;
+        CCTK_REAL *restrict gxx;
+        CCTK_REAL *restrict gyy;
+        CCTK_REAL *restrict gzz;
+        CCTK_REAL *restrict gxy;
+        CCTK_REAL *restrict gxz;
+        CCTK_REAL *restrict gyz;
+        CCTK_REAL *restrict betax;
+        CCTK_REAL *restrict betay;
+        CCTK_REAL *restrict betaz;
+        CCTK_REAL *restrict kxx;
+        CCTK_REAL *restrict kyy;
+        CCTK_REAL *restrict kzz;
+        CCTK_REAL *restrict kxy;
+        CCTK_REAL *restrict kxz;
+        CCTK_REAL *restrict kyz;
+        CCTK_REAL *restrict vel_x;
+        CCTK_REAL *restrict vel_y;
+        CCTK_REAL *restrict vel_z;
+        CCTK_REAL *restrict w_lorentz;
+        /* Composition, each NULL unless TOVola provides it; filled from beq */
+        CCTK_REAL *restrict Y_e;
+        CCTK_REAL *restrict temperature;
+        CCTK_REAL *restrict entropy;
+        const TOVola_beq_struct *beq;
+        /* Past timelevels written together with the current one, see TOVola_TOV_Populate_Timelevels */
+        int num_past_levels;
+        TOVola_past_gf_struct past[TOVOLA_MAX_PAST_LEVELS];
+} TOVola_gf_struct;
+
+/* One local grid patch to fill: a Carpet component, or the whole local grid under PUGH */
+typedef struct {
+        int lsh[3];
+        int ash[3];
+        const CCTK_REAL *restrict x;
+        const CCTK_REAL *restrict y;
+        const CCTK_REAL *restrict z;
+        TOVola_gf_struct gf;
+} TOVola_patch_struct;
+
+/* Linear index of point (i,j,k) of a patch, as CCTK_GFINDEX3D */
+#define TOVOLA_PATCH_INDEX(patch,i,j,k) ((i) + (patch)->ash[0]*((j) + (patch)->ash[1]*(k)))
+
+/* One star on the grid. Stars with the same central density point to the same profile. */
+#define TOVOLA_MAX_STARS 16
+typedef struct {
+        CCTK_REAL center[3];
+        TOVola_ID_persist_struct *profile;
+} TOVola_star_struct;
+
+/* Surface quantities of one star of a mass-radius sequence */
+typedef struct {
+        CCTK_REAL central_baryon_density;
+        CCTK_REAL mass;
+        CCTK_REAL baryon_mass;
+        CCTK_REAL radius_Schw;
+        CCTK_REAL radius_iso;
+        long num_rhs_evaluations;
+        CCTK_REAL dmass_drho_c;   // Only with TOVola_sensitivities
+        CCTK_REAL dradius_drho_c;
+        CCTK_REAL moment_of_inertia; // Only with TOVola_observables
+        CCTK_REAL love_k2;
+} TOVola_sequence_star_struct;
+
+/* Solve once and fill every given patch; shared by the local-mode and level-mode entry points */
+#ifdef __cplusplus
+extern "C"
+#endif
+void TOVola_Solve_and_Interp_patches(const int num_patches, TOVola_patch_struct *restrict patches);
+
+/* Point gf->past[] at the _p and _p_p fields in past[], as many as TOVola_TOV_Populate_Timelevels asks for (TOVola_driver.c) */
+#ifdef __cplusplus
+extern "C"
+#endif
+void TOVola_set_past_levels(TOVola_gf_struct *restrict gf, const TOVola_past_gf_struct past[TOVOLA_MAX_PAST_LEVELS]);
+
+/* Check TOVola_EOS_type and set up the EOS once; returns the eos_type code of TOVola_data_struct */
+#ifdef __cplusplus
+extern "C"
+#endif
+int TOVola_init_eos(void);
+
+/* Central density of the stable star with TOVola_target_mass or TOVola_target_baryon_mass, found once (TOVola_search.c) */
+#ifdef __cplusplus
+extern "C"
+#endif
+CCTK_REAL TOVola_target_central_density(void);
+
+/* Profile of one central density interpolated from the star library TOVola_star_library, without a solve (TOVola_library.c) */
+#ifdef __cplusplus
+extern "C"
+#endif
+void TOVola_library_profile(TOVola_ID_persist_struct *restrict TOVola_ID_persist, const CCTK_REAL central_baryon_density);
@@ -2,6 +2,12 @@
 #include "TOVola_interp.h"
 #include "TOVola_defines.h"
 #include "TOVola_solve.h"
+#include "TOVola_chebyshev.h"
+#include "TOVola_grid.h"
+#include "TOVola_profile.h"
+#include "TOVola_output.h"
+#include "TOVola_cache.h"
+#include "TOVola_import.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -48,304 +54,419 @@
 #define TOVOLA_R_ISO 3
 #define NEGATIVE_R_INTERP_BUFFER 11
 
-//Helpful defines for later.
-#define velx (&vel[0*cctk_lsh[0]*cctk_lsh[1]*cctk_lsh[2]])
-#define vely (&vel[1*cctk_lsh[0]*cctk_lsh[1]*cctk_lsh[2]])
-#define velz (&vel[2*cctk_lsh[0]*cctk_lsh[1]*cctk_lsh[2]])
+//Helpful defines for later. The components of vel are one padded (cctk_ash) grid function apart.
+#define velx (&vel[0*cctk_ash[0]*cctk_ash[1]*cctk_ash[2]])
+#define vely (&vel[1*cctk_ash[0]*cctk_ash[1]*cctk_ash[2]])
+#define velz (&vel[2*cctk_ash[0]*cctk_ash[1]*cctk_ash[2]])
 //For timelevel population
-#define velx_p (&vel_p[0*cctk_lsh[0]*cctk_lsh[1]*cctk_lsh[2]])
-#define vely_p (&vel_p[1*cctk_lsh[0]*cctk_lsh[1]*cctk_lsh[2]])
-#define velz_p (&vel_p[2*cctk_lsh[0]*cctk_lsh[1]*cctk_lsh[2]])
-#define velx_p_p (&vel_p_p[0*cctk_lsh[0]*cctk_lsh[1]*cctk_lsh[2]])
-#define vely_p_p (&vel_p_p[1*cctk_lsh[0]*cctk_lsh[1]*cctk_lsh[2]])
-#define velz_p_p (&vel_p_p[2*cctk_lsh[0]*cctk_lsh[1]*cctk_lsh[2]])
+#define velx_p (&vel_p[0*cctk_ash[0]*cctk_ash[1]*cctk_ash[2]])
+#define vely_p (&vel_p[1*cctk_ash[0]*cctk_ash[1]*cctk_ash[2]])
+#define velz_p (&vel_p[2*cctk_ash[0]*cctk_ash[1]*cctk_ash[2]])
+#define velx_p_p (&vel_p_p[0*cctk_ash[0]*cctk_ash[1]*cctk_ash[2]])
+#define vely_p_p (&vel_p_p[1*cctk_ash[0]*cctk_ash[1]*cctk_ash[2]])
+#define velz_p_p (&vel_p_p[2*cctk_ash[0]*cctk_ash[1]*cctk_ash[2]])
 
 
-
-//Perform the TOV integration using GSL
-void TOVola_Solve_and_Interp(CCTK_ARGUMENTS){
+//Check TOVola_EOS_type against GRHayL's EOS and return the eos_type code of TOVola_data_struct.
+//The tabulated beta-equilibrium slice is computed by the first call only; later calls just return the code.
+int TOVola_init_eos(void){
 
   DECLARE_CCTK_PARAMETERS;
-  DECLARE_CCTK_ARGUMENTS;
-  TOVola_ID_persist_struct TOVola_ID_persist_tmp;  // allocates memory for the pointer below.
-  TOVola_ID_persist_struct *restrict TOVola_ID_persist = &TOVola_ID_persist_tmp;
-  CCTK_REAL current_position = 0;
-
-  /* Set up ODE system and driver */
-  TOVola_data_struct TOVdata_tmp; // allocates memory for the pointer below.
-  TOVola_data_struct *restrict TOVdata = &TOVdata_tmp;
-  gsl_odeiv2_system system;
-  gsl_odeiv2_driver *driver;
+  static int eos_type = -1;
 
-  //Checking and setting EOS
+  if (eos_type >= 0) return eos_type;
   if(CCTK_EQUALS("Simple",TOVola_EOS_type)){
     CCTK_INFO("Simple Polytrope");
-    TOVdata->eos_type = 0;
     if(ghl_eos->neos!=1){
       CCTK_INFO("Error: Too many regions for the simple polytrope.");
       CCTK_INFO("Check your value for neos, or use a piecewise polytrope");
-      CCTK_ERROR("Shutting down due to error...");}       
+      CCTK_ERROR("Shutting down due to error...");}
+    eos_type = 0;
     }
   else if(CCTK_EQUALS("Piecewise",TOVola_EOS_type)){
     CCTK_INFO("Piecewise Polytrope");
-    TOVdata->eos_type=1;}
+    eos_type = 1;}
   else if(CCTK_EQUALS("Tabulated",TOVola_EOS_type)){
     CCTK_INFO("Tabulated EOS");
-    TOVdata->eos_type=2;
     ghl_tabulated_compute_Ye_P_eps_of_rho_beq_constant_T(TOVola_Tin, ghl_eos);
+    eos_type = 2;
   }
   else{
     CCTK_INFO("ERROR: Invalid EOS type. Must be either 'Simple', 'Piecewise', or 'Tabulated'");
     CCTK_ERROR("Shutting down due to error...");}
+  return eos_type;
+}
+
+//Baryon mass of a solved profile; the mirrored samples at r<0 are skipped by TOVola_baryon_mass.
+static CCTK_REAL TOVola_profile_baryon_mass(const TOVola_ID_persist_struct *restrict TOVola_ID_persist){
+  return TOVola_baryon_mass(TOVola_ID_persist->numpoints_arr, TOVola_ID_persist->r_Schw_arr, TOVola_ID_persist->rho_baryon_arr, TOVola_ID_persist->M_arr);
+}
 
-  //Initialize other TOVdata member variables
-  TOVdata->numpoints_actually_saved = 0;
-  TOVdata->error_limit = TOVola_error_limit;
-  TOVdata->initial_ode_step_size = TOVola_initial_ode_step_size;
-  TOVdata->absolute_max_step = TOVola_absolute_max_step;
-  TOVdata->absolute_min_step = TOVola_absolute_min_step;
-  TOVdata->central_baryon_density = TOVola_central_baryon_density;
-  TOVdata->ghl_eos = ghl_eos;
-  if (setup_ode_system(TOVola_ODE_method, &system, &driver, TOVdata) != 0) {
-    CCTK_ERROR("Failed to set up ODE system.");
+/* Solver context of the profiles: created by the first solve and reused by the later ones (one per distinct star),
+   so the raw arrays and the GSL driver are allocated once. Freed with the profiles at TERMINATE. */
+static TOVola_data_struct TOVola_solver;
+static int TOVola_solver_created = 0;
+
+//Perform the TOV integration using GSL for one central baryon density, or read the raw profile TOVola_import_profile instead,
+//and fill TOVola_ID_persist with the normalized profile.
+//profile_index numbers the profile in the optional HDF5 output. Not thread safe; called under the TOVola_profiles lock.
+static void TOVola_solve_profile(TOVola_ID_persist_struct *restrict TOVola_ID_persist, const CCTK_REAL central_baryon_density, const int profile_index){
+
+  DECLARE_CCTK_PARAMETERS;
+
+  TOVola_data_struct *restrict TOVdata = &TOVola_solver;
+  if (!TOVola_solver_created) {
+    TOVola_set_solver_parameters(TOVdata, TOVola_init_eos(), central_baryon_density);
+    TOVdata->verbose = 1;
+    if (TOVola_import_profile[0] != '\0') TOVdata->store_derivatives = 0; // The file has none
+    TOVola_solver_created = 1;
   }
-  
-  CCTK_INFO("Starting TOV Integration using GSL for TOVola...");
-  /* Initialize ODE variables */
-  CCTK_REAL TOVola_eq[ODE_SOLVER_DIM];
-  CCTK_REAL c[2];
-  TOVola_get_initial_condition(TOVola_eq, TOVdata);
-  TOVola_assign_constants(c, TOVdata);
-
-  /* Initial memory allocation */
-  TOVdata->numels_alloced_TOV_arr = 1024;
-  if (initialize_tovola_data(TOVdata) != 0) {
-    gsl_odeiv2_driver_free(driver);
-    CCTK_ERROR("Failed to initialize TOVola_data_struct.");
+  TOVdata->central_baryon_density = central_baryon_density;
+  if (TOVola_import_profile[0] != '\0') {
+    TOVola_import_raw_profile(TOVdata, TOVola_import_profile, TOVola_import_profile_format);
+    CCTK_VINFO("Read %d samples of the rho_c = %.14e profile from '%s'.", TOVdata->numpoints_actually_saved,
+               TOVdata->central_baryon_density, TOVola_import_profile);
+  }
+  else if (TOVdata->eos_type == 0 && TOVola_scaling_cache_dir[0] != '\0') TOVola_cached_integrate(TOVdata, TOVola_ODE_method, TOVola_size, TOVola_scaling_cache_dir);
+  else TOVola_integrate(TOVdata, TOVola_ODE_method, TOVola_size);
+  if (TOVdata->observables)
+    CCTK_VINFO("Observables at rho_c = %.14e: M_baryon = %.14e, I = %.14e, k2 = %.14e", central_baryon_density,
+               TOVdata->baryon_mass, TOVdata->moment_of_inertia, TOVdata->love_k2);
+  if (TOVdata->sensitivities)
+    CCTK_VINFO("Sensitivities at rho_c = %.14e: dM/drho_c = %.14e, dR_Schw/drho_c = %.14e", central_baryon_density,
+               TOVdata->dmass_drho_c, TOVdata->dradius_drho_c);
+
+  // Mirror a few samples to r<0, so that interpolation never has to extrapolate to r=0
+  TOVola_mirror_to_negative_r(TOVdata);
+
+  /* Allocate and populate TOVola_ID_persist_struct arrays */
+  if (TOVola_alloc_persist_profile(TOVola_ID_persist, TOVdata->numpoints_actually_saved) != 0) {
+    free_tovola_data(TOVdata);
+    CCTK_ERROR("Memory allocation failed for TOVola_ID_persist_struct arrays.\n");
   }
 
-  /* Integration loop */
-  TOVdata->r_lengthscale = TOVola_initial_ode_step_size; // initialize dr to a crazy small value in double precision.
-  for (int i = 0; i < TOVola_size; i++) {
-    CCTK_REAL dr = 0.01 * TOVdata->r_lengthscale;
-    if (TOVdata->rho_baryon < 0.05 * TOVola_central_baryon_density) {
-      // To get a super-accurate mass, reduce the dr sampling near the surface of the star.
-      dr = 1e-6 * TOVdata->r_lengthscale;
+  /* Normalize and set data */
+  TOVola_Normalize_and_set_data_integrated(TOVdata, TOVola_ID_persist->r_Schw_arr, TOVola_ID_persist->rho_energy_arr, TOVola_ID_persist->rho_baryon_arr, TOVola_ID_persist->P_arr,
+                                           TOVola_ID_persist->M_arr, TOVola_ID_persist->expnu_arr, TOVola_ID_persist->exp4phi_arr, TOVola_ID_persist->r_iso_arr);
+
+  /* Hermite interpolation also needs the derivatives, which are converted while the raw data are still around */
+  if (TOVdata->store_derivatives) {
+    TOVola_ID_persist->interp_method = TOVOLA_INTERP_HERMITE;
+    if (TOVola_set_derivatives(TOVdata, TOVola_ID_persist) != 0) {
+      free_tovola_data(TOVdata);
+      CCTK_ERROR("Memory allocation failed for TOVola_ID_persist_struct derivatives.\n");
     }
-    /* Exception handling */
-    TOVola_exception_handler(current_position, TOVola_eq);
-
-    /* Apply ODE step */
-    int status = gsl_odeiv2_driver_apply(driver, &current_position, current_position + dr, TOVola_eq);
-    if (status != GSL_SUCCESS) {
-      CCTK_VINFO("GSL ODE solver failed with status %d.", status);
-      gsl_odeiv2_driver_free(driver);
-      CCTK_ERROR("Shutting down due to error");
-    };
-
-    /* Post-step exception handling */
-    TOVola_exception_handler(current_position, TOVola_eq);
-
-    /* Evaluate densities */
-    TOVola_evaluate_rho_and_eps(current_position, TOVola_eq, TOVdata);
-    TOVola_assign_constants(c, TOVdata);
-
-    /* Check if reallocation is needed */
-    if (TOVdata->numpoints_actually_saved >= TOVdata->numels_alloced_TOV_arr) {
-      // Update arr_size instead of modifying the macro
-      const int new_arr_size = 1.5 * TOVdata->numels_alloced_TOV_arr;
-      TOVdata->numels_alloced_TOV_arr = new_arr_size;
-      TOVdata->rSchw_arr = realloc(TOVdata->rSchw_arr, sizeof(CCTK_REAL) * new_arr_size);
-      TOVdata->rho_energy_arr = realloc(TOVdata->rho_energy_arr, sizeof(CCTK_REAL) * new_arr_size);
-      TOVdata->rho_baryon_arr = realloc(TOVdata->rho_baryon_arr, sizeof(CCTK_REAL) * new_arr_size);
-      TOVdata->P_arr = realloc(TOVdata->P_arr, sizeof(CCTK_REAL) * new_arr_size);
-      TOVdata->M_arr = realloc(TOVdata->M_arr, sizeof(CCTK_REAL) * new_arr_size);
-      TOVdata->nu_arr = realloc(TOVdata->nu_arr, sizeof(CCTK_REAL) * new_arr_size);
-      TOVdata->Iso_r_arr = realloc(TOVdata->Iso_r_arr, sizeof(CCTK_REAL) * new_arr_size);
-
-      if (!TOVdata->rSchw_arr || !TOVdata->rho_energy_arr || !TOVdata->rho_baryon_arr || !TOVdata->P_arr || !TOVdata->M_arr || !TOVdata->nu_arr ||
-          !TOVdata->Iso_r_arr) {
-        CCTK_ERROR("Memory reallocation failed during integration.\n");
-        gsl_odeiv2_driver_free(driver);
+  }
+
+  TOVola_ID_persist->baryon_mass = TOVdata->observables ? TOVdata->baryon_mass : TOVola_profile_baryon_mass(TOVola_ID_persist);
+  TOVola_ID_persist->moment_of_inertia = TOVdata->moment_of_inertia;
+  TOVola_ID_persist->love_k2 = TOVdata->love_k2;
+  if (TOVola_output_profile) TOVola_write_profile_h5(profile_index, TOVdata, TOVola_ID_persist);
+}
+
+//Build the interpolation representation of one solved profile, as requested by TOVola_interpolation_method
+static void TOVola_prepare_profile(TOVola_ID_persist_struct *restrict TOVola_ID_persist){
+
+  DECLARE_CCTK_PARAMETERS;
+
+  /* Build the fitted representation, if requested */
+  if(CCTK_EQUALS("Chebyshev",TOVola_interpolation_method)){
+    TOVola_ID_persist->interp_method = TOVOLA_INTERP_CHEBYSHEV;
+    if (TOVola_Chebyshev_fit(TOVola_ID_persist, TOVola_Chebyshev_tolerance, TOVola_Chebyshev_max_order,
+                             TOVola_Interpolation_Stencil, TOVola_Max_Interpolation_Stencil) != 0) {
+      free_ID_persist_data(TOVola_ID_persist);
+      CCTK_ERROR("Memory allocation failed for the TOVola Chebyshev profile.\n");
+    }
+  }
+  else if(CCTK_EQUALS("Lagrange",TOVola_interpolation_method)){
+    if (TOVola_adaptive_stencil){
+      const CCTK_REAL mean_stencil = TOVola_select_stencils(TOVola_ID_persist, TOVola_Interpolation_Stencil, TOVola_Max_Interpolation_Stencil,
+                                                            TOVola_adaptive_stencil_tolerance);
+      if (mean_stencil < 0) {
+        free_ID_persist_data(TOVola_ID_persist);
+        CCTK_ERROR("Memory allocation failed for the TOVola adaptive stencils.\n");
       }
+      CCTK_VINFO("Adaptive interpolation stencil: mean size %.2f (maximum %d).", mean_stencil, (int)TOVola_Interpolation_Stencil);
     }
+  }
+  else if(!CCTK_EQUALS("Hermite",TOVola_interpolation_method)){
+    CCTK_INFO("ERROR: Invalid interpolation method. Must be either 'Lagrange', 'Hermite' or 'Chebyshev'");
+    CCTK_ERROR("Shutting down due to error...");}
+}
 
-    /* Store data */
-    TOVdata->rSchw_arr[TOVdata->numpoints_actually_saved] = current_position;
-    TOVdata->rho_energy_arr[TOVdata->numpoints_actually_saved] = c[0];
-    TOVdata->rho_baryon_arr[TOVdata->numpoints_actually_saved] = c[1];
-    TOVdata->P_arr[TOVdata->numpoints_actually_saved] = TOVola_eq[TOVOLA_PRESSURE];
-    TOVdata->M_arr[TOVdata->numpoints_actually_saved] = TOVola_eq[TOVOLA_MASS];
-    TOVdata->nu_arr[TOVdata->numpoints_actually_saved] = TOVola_eq[TOVOLA_NU];
-    TOVdata->Iso_r_arr[TOVdata->numpoints_actually_saved] = TOVola_eq[TOVOLA_R_ISO];
-    TOVdata->numpoints_actually_saved++;
-
-    /* Termination condition */
-    if (TOVola_do_we_terminate(current_position, TOVola_eq, TOVdata)) {
-      CCTK_VINFO("Finished Integration at position %.6e with Mass %.14e", current_position, TOVola_eq[TOVOLA_MASS]);
-      break;
+/* The stars and their profiles persist after grid placement. Later calls (further Carpet components, other refinement
+   levels, and the query functions of TOVola_profile.h) reuse them instead of integrating again. They are freed at TERMINATE. */
+static TOVola_star_struct TOVola_stars[TOVOLA_MAX_STARS];
+static TOVola_ID_persist_struct TOVola_profiles[TOVOLA_MAX_STARS];
+static int TOVola_num_stars_solved = 0, TOVola_num_profiles = 0, TOVola_profiles_prepared = 0;
+
+//Set up the stars and solve one profile per distinct central density, unless that was already done:
+//identical stars share the integration and the profile. Safe to call from any thread. The profiles are not yet
+//prepared for interpolation; see TOVola_ensure_profiles.
+static void TOVola_ensure_solved(void){
+
+  DECLARE_CCTK_PARAMETERS;
+
+#pragma omp critical(TOVola_profiles)
+  {
+    if (TOVola_num_stars_solved == 0){
+      CCTK_REAL profile_central_baryon_density[TOVOLA_MAX_STARS];
+      int num_profiles = 0;
+      //An imported profile is the only one, and its central density comes from the file: every star shares it.
+      const int importing = TOVola_import_profile[0] != '\0';
+      if (importing && (TOVola_star_library[0] != '\0' || TOVola_observables || TOVola_sensitivities))
+        CCTK_ERROR("TOVola_import_profile cannot be combined with TOVola_star_library, TOVola_observables or TOVola_sensitivities.");
+      //Library profiles are interpolated, not integrated: there are no raw samples to write and no sensitivities.
+      const int use_library = TOVola_star_library[0] != '\0';
+      if (use_library && (TOVola_output_profile || TOVola_sensitivities))
+        CCTK_ERROR("TOVola_star_library cannot be combined with TOVola_output_profile or TOVola_sensitivities.");
+      //With a target mass, TOVola_central_baryon_density is only the initial guess of the search.
+      const CCTK_REAL default_rho_c = (!importing && (TOVola_target_mass > 0 || TOVola_target_baryon_mass > 0)) ? TOVola_target_central_density()
+                                                                                                                  : TOVola_central_baryon_density;
+      for(int s=0; s<TOVola_num_stars; s++){
+        const CCTK_REAL rho_c = (!importing && TOVola_star_central_baryon_density[s] > 0.0) ? TOVola_star_central_baryon_density[s] : default_rho_c;
+        int q = 0;
+        while (q < num_profiles && profile_central_baryon_density[q] != rho_c) q++;
+        if (q == num_profiles) profile_central_baryon_density[num_profiles++] = rho_c;
+        TOVola_stars[s].center[0] = TOVola_star_x[s];
+        TOVola_stars[s].center[1] = TOVola_star_y[s];
+        TOVola_stars[s].center[2] = TOVola_star_z[s];
+        TOVola_stars[s].profile = &TOVola_profiles[q];
+      }
+      if (TOVola_num_stars > 1) CCTK_VINFO("Superposing %d stars from %d TOV solutions.", (int)TOVola_num_stars, num_profiles);
+      //A star library or an imported profile replaces the solves; their profiles carry no derivatives, so Hermite falls back to Lagrange.
+      if ((use_library || importing) && CCTK_EQUALS("Hermite",TOVola_interpolation_method))
+        CCTK_VWARN(CCTK_WARN_ALERT, "Profiles from %s have no derivatives; interpolating with Lagrange instead of Hermite.",
+                   use_library ? "the TOVola star library" : "TOVola_import_profile");
+      for(int q=0; q<num_profiles; q++){
+        if (use_library) TOVola_library_profile(&TOVola_profiles[q], profile_central_baryon_density[q]);
+        else TOVola_solve_profile(&TOVola_profiles[q], profile_central_baryon_density[q], q);
+      }
+      TOVola_num_profiles = num_profiles;
+      TOVola_num_stars_solved = TOVola_num_stars;
     }
   }
+}
 
-  /* Cleanup */
-  gsl_odeiv2_driver_free(driver);
-  CCTK_INFO("ODE Solver using GSL for TOVola Shutting Down...");
+//Solve the profiles if needed, and build their interpolation representations, unless that was already done.
+//The Chebyshev fit and the adaptive stencils have parallel loops of their own, so call this outside of parallel regions.
+static void TOVola_ensure_profiles(void){
 
-  // Data in TOVdata->*_arr are stored at r=TOVdata->initial_ode_step_size > 0 up to the stellar surface.
-  // However, we may need data at r=0, which would require extrapolation.
-  // To prevent that, we copy INTERP_BUFFER data points from r>0 to r<0 so that we can always interpolate.
-  CCTK_REAL *restrict tmp = malloc(sizeof(CCTK_REAL) * (TOVdata->numpoints_actually_saved + NEGATIVE_R_INTERP_BUFFER));
+  TOVola_ensure_solved();
+#pragma omp critical(TOVola_profiles)
+  {
+    if (!TOVola_profiles_prepared){
+      for(int q=0; q<TOVola_num_profiles; q++) TOVola_prepare_profile(&TOVola_profiles[q]);
+      TOVola_profiles_prepared = 1;
+    }
+  }
+}
 
-  extend_to_negative_r(TOVdata->rSchw_arr, -1.0, tmp, TOVdata);
-  extend_to_negative_r(TOVdata->rho_energy_arr, +1.0, tmp, TOVdata);
-  extend_to_negative_r(TOVdata->rho_baryon_arr, +1.0, tmp, TOVdata);
-  extend_to_negative_r(TOVdata->P_arr, +1.0, tmp, TOVdata);
-  extend_to_negative_r(TOVdata->M_arr, +1.0, tmp, TOVdata);
-  extend_to_negative_r(TOVdata->nu_arr, +1.0, tmp, TOVdata);
-  extend_to_negative_r(TOVdata->Iso_r_arr, -1.0, tmp, TOVdata);
+//Copy the surface quantities of every star into the TOVola_star_observables grid arrays
+void TOVola_Set_Observables(CCTK_ARGUMENTS){
 
-  free(tmp);
-  TOVdata->numpoints_actually_saved += NEGATIVE_R_INTERP_BUFFER;
+  DECLARE_CCTK_ARGUMENTS;
+  DECLARE_CCTK_PARAMETERS;
 
-  /* Allocate and populate TOVola_ID_persist_struct arrays */
-  TOVola_ID_persist->r_Schw_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * TOVdata->numpoints_actually_saved);
-  TOVola_ID_persist->rho_energy_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * TOVdata->numpoints_actually_saved);
-  TOVola_ID_persist->rho_baryon_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * TOVdata->numpoints_actually_saved);
-  TOVola_ID_persist->P_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * TOVdata->numpoints_actually_saved);
-  TOVola_ID_persist->M_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * TOVdata->numpoints_actually_saved);
-  TOVola_ID_persist->expnu_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * TOVdata->numpoints_actually_saved);
-  TOVola_ID_persist->exp4phi_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * TOVdata->numpoints_actually_saved);
-  TOVola_ID_persist->r_iso_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * TOVdata->numpoints_actually_saved);
-
-  if (!TOVola_ID_persist->r_Schw_arr || !TOVola_ID_persist->rho_energy_arr || !TOVola_ID_persist->rho_baryon_arr || !TOVola_ID_persist->P_arr || !TOVola_ID_persist->M_arr ||
-      !TOVola_ID_persist->expnu_arr || !TOVola_ID_persist->exp4phi_arr || !TOVola_ID_persist->r_iso_arr) {
-    free_tovola_data(TOVdata);
-    CCTK_ERROR("Memory allocation failed for TOVola_ID_persist_struct arrays.\n");
+  TOVola_ensure_profiles();
+  for(int s=0; s<TOVola_num_stars_solved; s++){
+    const TOVola_ID_persist_struct *restrict TOVola_ID_persist = TOVola_stars[s].profile;
+    const int surface = TOVola_ID_persist->numpoints_arr - 1;
+    const CCTK_REAL M = TOVola_ID_persist->M_arr[surface];
+    const CCTK_REAL C = M / TOVola_ID_persist->r_Schw_arr[surface];
+    TOVola_gravitational_mass[s] = M;
+    TOVola_baryonic_mass[s] = TOVola_ID_persist->baryon_mass;
+    TOVola_moment_of_inertia[s] = TOVola_ID_persist->moment_of_inertia;
+    TOVola_Love_k2[s] = TOVola_ID_persist->love_k2;
+    TOVola_tidal_deformability[s] = 2.0 * TOVola_ID_persist->love_k2 / (3.0 * pow(C, 5)); // Lambda = 2 k2 / (3 C^5)
   }
+}
 
-  TOVola_ID_persist->numpoints_arr = TOVdata->numpoints_actually_saved;
+//Release the persistent profiles
+void TOVola_Free_Profiles(CCTK_ARGUMENTS){
+  for(int q=0; q<TOVola_num_profiles; q++) free_ID_persist_data(&TOVola_profiles[q]);
+  TOVola_num_profiles = 0;
+  if (TOVola_solver_created) {
+    free_tovola_data(&TOVola_solver);
+    TOVola_solver_created = 0;
+  }
+  TOVola_num_stars_solved = 0;
+  TOVola_profiles_prepared = 0;
+}
 
-  /* Normalize and set data */
-  TOVola_Normalize_and_set_data_integrated(TOVdata, TOVola_ID_persist->r_Schw_arr, TOVola_ID_persist->rho_energy_arr, TOVola_ID_persist->rho_baryon_arr, TOVola_ID_persist->P_arr,
-                                           TOVola_ID_persist->M_arr, TOVola_ID_persist->expnu_arr, TOVola_ID_persist->exp4phi_arr, TOVola_ID_persist->r_iso_arr);
+/* Profile queries for other thorns, provided as aliased functions; see TOVola_profile.h */
 
-  /* Free raw data as it's no longer needed */
-  free_tovola_data(TOVdata);
+//The profile of star number star, solved first if needed, or NULL for an invalid star.
+static const TOVola_ID_persist_struct *TOVola_query_profile(const CCTK_INT star){
+  TOVola_ensure_profiles();
+  if (star < 0 || star >= TOVola_num_stars_solved) return NULL;
+  return TOVola_stars[star].profile;
+}
+
+CCTK_INT TOVola_InterpolateProfile_impl(const CCTK_INT star, const CCTK_INT npoints, const CCTK_REAL *restrict r_iso,
+                                        const CCTK_INT nfields, const CCTK_INT *restrict fields, CCTK_REAL *restrict values){
+
+  DECLARE_CCTK_PARAMETERS;
+
+  const TOVola_ID_persist_struct *restrict TOVola_ID_persist = TOVola_query_profile(star);
+  if (!TOVola_ID_persist) return TOVOLA_PROFILE_ERROR_STAR;
+  for(int f=0; f<nfields; f++){
+    if (fields[f] < 0 || fields[f] >= TOVOLA_PROFILE_NUM_FIELDS) return TOVOLA_PROFILE_ERROR_FIELD;}
+
+  //Always the Lagrange stencil on the raw profile: it is the one representation that also carries m(r).
+#pragma omp parallel for schedule(static) if(npoints > 1024)
+  for(int p=0; p<npoints; p++){
+    const CCTK_REAL rr_iso = fabs(r_iso[p]);
+    CCTK_REAL TOVola_vals[TOVOLA_PROFILE_NUM_FIELDS], TOVola_expnu;
+    TOVola_TOV_interpolate_1D(rr_iso, TOVola_Interpolation_Stencil, TOVola_Max_Interpolation_Stencil,
+                              TOVola_ID_persist->numpoints_arr, TOVola_ID_persist->r_Schw_arr,
+                              TOVola_ID_persist->rho_energy_arr, TOVola_ID_persist->rho_baryon_arr, TOVola_ID_persist->P_arr,
+                              TOVola_ID_persist->M_arr, TOVola_ID_persist->expnu_arr, TOVola_ID_persist->exp4phi_arr, TOVola_ID_persist->r_iso_arr,
+                              &TOVola_vals[TOVOLA_PROFILE_RHO_ENERGY], &TOVola_vals[TOVOLA_PROFILE_RHO_BARYON], &TOVola_vals[TOVOLA_PROFILE_PRESSURE],
+                              &TOVola_vals[TOVOLA_PROFILE_MASS], &TOVola_expnu, &TOVola_vals[TOVOLA_PROFILE_EXP4PHI]);
+    TOVola_vals[TOVOLA_PROFILE_LAPSE] = sqrt(TOVola_expnu);
+    TOVola_vals[TOVOLA_PROFILE_R_SCHW] = rr_iso*sqrt(TOVola_vals[TOVOLA_PROFILE_EXP4PHI]); // exp4phi = (r_Schw/r_iso)^2
+    for(int f=0; f<nfields; f++) values[f*npoints + p] = TOVola_vals[fields[f]];
+  }
+  return 0;
+}
+
+CCTK_REAL TOVola_GetMass_impl(const CCTK_INT star){
+  const TOVola_ID_persist_struct *restrict TOVola_ID_persist = TOVola_query_profile(star);
+  return TOVola_ID_persist ? TOVola_ID_persist->M_arr[TOVola_ID_persist->numpoints_arr-1] : -1.0;
+}
+
+CCTK_REAL TOVola_GetRadiusSchw_impl(const CCTK_INT star){
+  const TOVola_ID_persist_struct *restrict TOVola_ID_persist = TOVola_query_profile(star);
+  return TOVola_ID_persist ? TOVola_ID_persist->r_Schw_arr[TOVola_ID_persist->numpoints_arr-1] : -1.0;
+}
+
+CCTK_REAL TOVola_GetRadiusIso_impl(const CCTK_INT star){
+  const TOVola_ID_persist_struct *restrict TOVola_ID_persist = TOVola_query_profile(star);
+  return TOVola_ID_persist ? TOVola_ID_persist->r_iso_arr[TOVola_ID_persist->numpoints_arr-1] : -1.0;
+}
+
+CCTK_REAL TOVola_GetBaryonMass_impl(const CCTK_INT star){
+  const TOVola_ID_persist_struct *restrict TOVola_ID_persist = TOVola_query_profile(star);
+  return TOVola_ID_persist ? TOVola_ID_persist->baryon_mass : -1.0;
+}
+
+//Solve once per distinct star (if not done yet), and interpolate to every given patch
+void TOVola_Solve_and_Interp_patches(const int num_patches, TOVola_patch_struct *restrict patches){
+
+  DECLARE_CCTK_PARAMETERS;
+
+  //Y_e, temperature and entropy only make sense on the beta-equilibrium slice of a tabulated EOS.
+  const int provide_composition = CCTK_EQUALS(initial_Y_e,"TOVola") || CCTK_EQUALS(initial_temperature,"TOVola") || CCTK_EQUALS(initial_entropy,"TOVola");
+  if(provide_composition && !CCTK_EQUALS("Tabulated",TOVola_EOS_type)){
+    CCTK_INFO("ERROR: TOVola can only provide initial_Y_e, initial_temperature and initial_entropy for a tabulated EOS.");
+    CCTK_ERROR("Shutting down due to error...");}
+
+  //Most of what we write does not depend on the profile. Those fields are handed out as tasks,
+  //which the other threads work through while the encountering thread integrates (on the first call only).
+#pragma omp parallel
+  {
+#pragma omp single
+    {
+      for(int p=0; p<num_patches; p++) TOVola_spawn_static_tasks(&patches[p]);
+      TOVola_ensure_solved();
+    }
+  }
+  //Profile post-processing runs after the region, with its own parallel loops.
+  TOVola_ensure_profiles();
+
+  /* The composition comes from the slice the star was integrated on */
+  TOVola_beq_struct TOVola_beq;
+  TOVola_beq.S_of_lr = NULL;
+  if (provide_composition){
+    if (TOVola_set_beq_slice(ghl_eos, TOVola_Tin, &TOVola_beq) != 0) {
+      CCTK_ERROR("Memory allocation failed for the TOVola beta-equilibrium slice.\n");
+    }
+    for(int p=0; p<num_patches; p++) patches[p].gf.beq = &TOVola_beq;
+  }
 
-  /* Now to interp, and finalize the grid. */
-  CCTK_REAL TOVola_Rbar = TOVola_ID_persist->r_iso_arr[TOVola_ID_persist->numpoints_arr-1]; 
-  CCTK_REAL TOVola_Mass = TOVola_ID_persist->M_arr[TOVola_ID_persist->numpoints_arr-1];
-  
-  
   //Now for the actual grid placements. Go over all grid points
   CCTK_INFO("TOVola Beginning Grid Placements...");
-#pragma omp parallel for
-  for(int i=0; i<cctk_lsh[0]; i++){ 
-  	for(int j=0; j<cctk_lsh[1]; j++){ 
-  		for(int k=0; k<cctk_lsh[2]; k++){ 
-  			int i3d=CCTK_GFINDEX3D(cctkGH,i,j,k); //3D index
-  			CCTK_REAL TOVola_r_iso = sqrt((x[i3d]*x[i3d])+(y[i3d]*y[i3d])+(z[i3d]*z[i3d])); //magnitude of r on the grid
-  			CCTK_REAL TOVola_rho_energy, TOVola_rho_baryon, TOVola_P, TOVola_M, TOVola_expnu, TOVola_exp4phi; //Declare TOV quantities
-  			if (TOVola_r_iso < TOVola_Rbar){ //If we are INSIDE the star, we need to interpollate the data to the grid.
-  				TOVola_TOV_interpolate_1D(TOVola_r_iso, TOVola_Interpolation_Stencil, TOVola_Max_Interpolation_Stencil,
-                                      TOVola_ID_persist->numpoints_arr, TOVola_ID_persist->r_Schw_arr,
-                                      TOVola_ID_persist->rho_energy_arr, TOVola_ID_persist->rho_baryon_arr, TOVola_ID_persist->P_arr,
-                                      TOVola_ID_persist->M_arr, TOVola_ID_persist->expnu_arr, TOVola_ID_persist->exp4phi_arr,
-                                      TOVola_ID_persist->r_iso_arr, &TOVola_rho_energy, &TOVola_rho_baryon, &TOVola_P,
-                                      &TOVola_M, &TOVola_expnu, &TOVola_exp4phi);
-  				rho[i3d] = TOVola_rho_baryon;
-				press[i3d] = TOVola_P;
-				// tiny number prevents 0/0.
-				eps[i3d] = (TOVola_rho_energy / (TOVola_rho_baryon+1e-30)) - 1.0;
-				if (eps[i3d]<0){eps[i3d]=0.0;}
-				alp[i3d] = pow(TOVola_expnu,0.5);//This is the lapse
-				gxx[i3d] = TOVola_exp4phi;//This is the values for the metric in the coordinates we chose.
-				gyy[i3d] = gxx[i3d];
-				gzz[i3d] = gxx[i3d];}
-			else { //If we are OUTSIDE the star, we need to calculate the grid functions directly. Thank you, Schwarzchild.
-				CCTK_REAL TOVola_rSchw_outside = (TOVola_r_iso+TOVola_Mass) + TOVola_Mass*TOVola_Mass/(4.0*TOVola_r_iso);//Need to know what rSchw is at our current grid location.
-				rho[i3d] = 0.0;
-				press[i3d] = 0.0;
-				eps[i3d] = 0.0;
-				alp[i3d] = pow(1-2*TOVola_Mass/TOVola_rSchw_outside,0.5); //Goes to Schwarschild
-				gxx[i3d] = pow((TOVola_rSchw_outside/TOVola_r_iso),2.0);
-				gyy[i3d] = gxx[i3d];
-				gzz[i3d] = gxx[i3d];
-				}
-			
-			betax[i3d] = 0.0;
-			betay[i3d] = 0.0;
-			betaz[i3d] = 0.0;
-			gxy[i3d] = 0.0;
-			gxz[i3d] = 0.0;
-			gyz[i3d] = 0.0;
-			//Curvature is zero for our slice.
-			kxx[i3d] = 0.0;
-			kyy[i3d] = 0.0;
-			kzz[i3d] = 0.0;
-			kxy[i3d] = 0.0;
-			kxz[i3d] = 0.0;
-			kyz[i3d] = 0.0;
-			//velocities are zero: It is a static solution.
-			velx[i3d] = 0.0;
-			vely[i3d] = 0.0;
-			velz[i3d] = 0.0;
-	        	w_lorentz[i3d] = 1.0;
-  		}
-  	}
+  if(!CCTK_EQUALS("pointwise",TOVola_grid_placement) && !CCTK_EQUALS("batched",TOVola_grid_placement) &&
+     !CCTK_EQUALS("sorted",TOVola_grid_placement) && !CCTK_EQUALS("memoized",TOVola_grid_placement)){
+    CCTK_VINFO("ERROR: Invalid grid placement '%s'. Must be either 'pointwise', 'batched', 'sorted' or 'memoized'", TOVola_grid_placement);
+    CCTK_ERROR("Shutting down due to error...");}
+  const int num_stars = TOVola_num_stars_solved;
+  if(TOVola_stars_superposed(TOVola_stars, num_stars) && !CCTK_EQUALS("pointwise",TOVola_grid_placement)){
+    CCTK_VINFO("Superposed stars are placed tile by tile; TOVola_grid_placement = '%s' only applies to a single star at the origin.", TOVola_grid_placement);}
+  const int retval = num_patches == 1 ? TOVola_fill_grid(&patches[0], TOVola_stars, num_stars, TOVola_grid_placement, TOVola_Interpolation_Stencil, TOVola_Max_Interpolation_Stencil)
+                                      : TOVola_fill_patches(num_patches, patches, TOVola_stars, num_stars, TOVola_grid_placement, TOVola_Interpolation_Stencil, TOVola_Max_Interpolation_Stencil);
+  if (retval != 0) {
+    CCTK_ERROR("Memory allocation failed for TOVola grid placement.\n");
   }
   			
   CCTK_INFO("Grid Placement Successful!");
-  CCTK_INFO("Populating Time Levels...");
+  
+  free(TOVola_beq.S_of_lr);
+}
 
-  //This is to populate time levels.
-  //Luckily, this is a static solution, so the logic isn't too complicated.
-  //From the original TOVsolver in the toolkit.
-  int i3d = cctk_lsh[2]*cctk_lsh[1]*cctk_lsh[0];
+//The placement runs once per component or level; this reports once, after the finest level.
+void TOVola_Finish(CCTK_ARGUMENTS){
+  CCTK_INFO("Complete! Enjoy your initial data!");
+  CCTK_INFO("TOVola shutting down...");
+}
+
+//This is to populate time levels. Luckily, this is a static solution, so every past level gets the values of the current one,
+//written in the same pass. past[] holds the _p and _p_p fields; as many as TOVola_TOV_Populate_Timelevels asks for are used.
+void TOVola_set_past_levels(TOVola_gf_struct *restrict gf, const TOVola_past_gf_struct past[TOVOLA_MAX_PAST_LEVELS]){
+  DECLARE_CCTK_PARAMETERS;
+  gf->num_past_levels = 0;
   switch(TOVola_TOV_Populate_Timelevels)
   {
     case 3:
-        TOVola_TOV_Copy(i3d, gxx_p_p,  gxx);
-        TOVola_TOV_Copy(i3d, gyy_p_p,  gyy);
-        TOVola_TOV_Copy(i3d, gzz_p_p,  gzz);
-        TOVola_TOV_Copy(i3d, gxy_p_p,  gxy);
-        TOVola_TOV_Copy(i3d, gxz_p_p,  gxz);
-        TOVola_TOV_Copy(i3d, gyz_p_p,  gyz);
-        TOVola_TOV_Copy(i3d, rho_p_p,  rho);
-        TOVola_TOV_Copy(i3d, eps_p_p,  eps);
-        TOVola_TOV_Copy(i3d, velx_p_p, velx);
-        TOVola_TOV_Copy(i3d, vely_p_p, vely);
-        TOVola_TOV_Copy(i3d, velz_p_p, velz);
-        TOVola_TOV_Copy(i3d, w_lorentz_p_p, w_lorentz);
+        gf->past[1] = past[1];
         // fall through
     case 2:
-        TOVola_TOV_Copy(i3d, gxx_p,  gxx);
-        TOVola_TOV_Copy(i3d, gyy_p,  gyy);
-        TOVola_TOV_Copy(i3d, gzz_p,  gzz);
-        TOVola_TOV_Copy(i3d, gxy_p,  gxy);
-        TOVola_TOV_Copy(i3d, gxz_p,  gxz);
-        TOVola_TOV_Copy(i3d, gyz_p,  gyz);
-        TOVola_TOV_Copy(i3d, rho_p,  rho);
-        TOVola_TOV_Copy(i3d, eps_p,  eps);
-        TOVola_TOV_Copy(i3d, velx_p, velx);
-        TOVola_TOV_Copy(i3d, vely_p, vely);
-        TOVola_TOV_Copy(i3d, velz_p, velz);
-        TOVola_TOV_Copy(i3d, w_lorentz_p, w_lorentz);
+        gf->past[0] = past[0];
+        gf->num_past_levels = TOVola_TOV_Populate_Timelevels-1;
         // fall through
     case 1:
         break;
     default:
         CCTK_VWARN(CCTK_WARN_ABORT,
-                   "Unsupported number of TOVola_TOV_Populate_TimelevelsL: %d",
+                   "Unsupported number of TOVola_TOV_Populate_Timelevels: %d",
                    (int)TOVola_TOV_Populate_Timelevels);
         break;
   }
+}
 
+//Local-mode entry point: solve, and interpolate to the local grid (or to one Carpet component per call)
+void TOVola_Solve_and_Interp(CCTK_ARGUMENTS){
 
-  CCTK_INFO("Population Complete!");
-  
-  free_ID_persist_data(TOVola_ID_persist);
-  
-  CCTK_INFO("Complete! Enjoy your initial data!");
-  CCTK_INFO("TOVola shutting down...");
+  DECLARE_CCTK_PARAMETERS;
+  DECLARE_CCTK_ARGUMENTS;
+
+  TOVola_patch_struct TOVola_patch = {
+    .lsh = {cctk_lsh[0], cctk_lsh[1], cctk_lsh[2]},
+    .ash = {cctk_ash[0], cctk_ash[1], cctk_ash[2]},
+    .x = x, .y = y, .z = z};
+  TOVola_gf_struct *restrict TOVola_gf = &TOVola_patch.gf;
+  *TOVola_gf = (TOVola_gf_struct){
+    .rho = rho, .press = press, .eps = eps, .alp = alp,
+    .gxx = gxx, .gyy = gyy, .gzz = gzz, .gxy = gxy, .gxz = gxz, .gyz = gyz,
+    .betax = betax, .betay = betay, .betaz = betaz,
+    .kxx = kxx, .kyy = kyy, .kzz = kzz, .kxy = kxy, .kxz = kxz, .kyz = kyz,
+    .vel_x = velx, .vel_y = vely, .vel_z = velz, .w_lorentz = w_lorentz,
+    .Y_e = CCTK_EQUALS(initial_Y_e,"TOVola") ? Y_e : NULL,
+    .temperature = CCTK_EQUALS(initial_temperature,"TOVola") ? temperature : NULL,
+    .entropy = CCTK_EQUALS(initial_entropy,"TOVola") ? entropy : NULL,
+    .beq = NULL, .num_past_levels = 0};
+  TOVola_set_past_levels(TOVola_gf, (const TOVola_past_gf_struct[TOVOLA_MAX_PAST_LEVELS]){
+    { .rho = rho_p, .eps = eps_p, .gxx = gxx_p, .gyy = gyy_p, .gzz = gzz_p, .gxy = gxy_p, .gxz = gxz_p, .gyz = gyz_p,
+      .vel_x = velx_p, .vel_y = vely_p, .vel_z = velz_p, .w_lorentz = w_lorentz_p,
+      .Y_e = CCTK_EQUALS(initial_Y_e,"TOVola") ? Y_e_p : NULL,
+      .temperature = CCTK_EQUALS(initial_temperature,"TOVola") ? temperature_p : NULL,
+      .entropy = CCTK_EQUALS(initial_entropy,"TOVola") ? entropy_p : NULL },
+    { .rho = rho_p_p, .eps = eps_p_p, .gxx = gxx_p_p, .gyy = gyy_p_p, .gzz = gzz_p_p, .gxy = gxy_p_p, .gxz = gxz_p_p, .gyz = gyz_p_p,
+      .vel_x = velx_p_p, .vel_y = vely_p_p, .vel_z = velz_p_p, .w_lorentz = w_lorentz_p_p,
+      .Y_e = CCTK_EQUALS(initial_Y_e,"TOVola") ? Y_e_p_p : NULL,
+      .temperature = CCTK_EQUALS(initial_temperature,"TOVola") ? temperature_p_p : NULL,
+      .entropy = CCTK_EQUALS(initial_entropy,"TOVola") ? entropy_p_p : NULL }});
+
+  TOVola_Solve_and_Interp_patches(1, &TOVola_patch);
 }
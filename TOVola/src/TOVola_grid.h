@@ -0,0 +1,751 @@
+#pragma once
+
+//This header file holds the grid-fill engine: the point writers and the placement paths that put the normalized profile on the ET grid.
+//All paths walk a patch in k-j-i (memory) order, hand out (k, tile of j rows) pairs with a static collapse(2) schedule,
+//and finish each tile in two short sweeps, so the radii stay in cache and every thread touches the same pages on every pass.
+//When many patches are filled together, the same tiles are queued as tasks across all of them instead.
+//Several stars, or one off the origin, are superposed tile by tile; the placement modes below are for one star at the origin.
+//The constant fields are written separately, as tasks that overlap the ODE solve.
+
+#include "TOVola_defines.h"
+#include "TOVola_interp.h"
+#include "TOVola_chebyshev.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <cctk.h>
+#include <cctk_Arguments.h>
+#include <cctk_Parameters.h>
+
+/* Number of j rows in one tile. A tile of x-lines is small enough to keep its radii in L1/L2 between sweeps. */
+#define TOVOLA_TILE_J 4
+
+/* What the tile engine does with a point inside the star */
+#define TOVOLA_FILL_POINTWISE 0 //interpolate and write it immediately
+#define TOVOLA_FILL_BATCHED 1   //collect it into per-row batches for the SIMD interpolator
+#define TOVOLA_FILL_DEFERRED 2  //leave it for a later sorted or memoized pass
+#define TOVOLA_FILL_SUPERPOSED 3 //add up the fields of all stars, see TOVola_fill_tile_superposed
+
+/* Where a box of grid points lies relative to the stellar surface */
+#define TOVOLA_REGION_EXTERIOR 0
+#define TOVOLA_REGION_INTERIOR 1
+#define TOVOLA_REGION_STRADDLING 2
+
+//The solution is static, so past timelevels of the profile-dependent fields get the values just written to the current one.
+static inline void TOVola_set_past_point(const int i3d, const TOVola_gf_struct *restrict gf){
+  for(int l=0; l<gf->num_past_levels; l++){
+    const TOVola_past_gf_struct *restrict past = &gf->past[l];
+    past->rho[i3d] = gf->rho[i3d];
+    past->eps[i3d] = gf->eps[i3d];
+    past->gxx[i3d] = gf->gxx[i3d];
+    past->gyy[i3d] = gf->gxx[i3d];
+    past->gzz[i3d] = gf->gxx[i3d];
+  }
+}
+
+//Y_e and entropy on the beta-equilibrium slice at baryon density rho: linear in log(rho) between table samples, clamped to the table.
+static inline void TOVola_beq_lookup(const TOVola_beq_struct *restrict beq, const CCTK_REAL rho, CCTK_REAL *restrict Y_e, CCTK_REAL *restrict S){
+  const int n = beq->N_rho;
+  const CCTK_REAL lr = rho > 0.0 ? log(rho) : beq->logrho[0];
+  if (!(lr > beq->logrho[0])) {*Y_e = beq->Ye_of_lr[0]; *S = beq->S_of_lr[0]; return;}
+  if (!(lr < beq->logrho[n-1])) {*Y_e = beq->Ye_of_lr[n-1]; *S = beq->S_of_lr[n-1]; return;}
+  int lo = 0, hi = n-1;
+  while (hi - lo > 1){
+    const int mid = (lo + hi) / 2;
+    if (beq->logrho[mid] > lr) hi = mid;
+    else lo = mid;
+  }
+  const CCTK_REAL w = (lr - beq->logrho[lo]) / (beq->logrho[hi] - beq->logrho[lo]);
+  *Y_e = (1.0-w)*beq->Ye_of_lr[lo] + w*beq->Ye_of_lr[hi];
+  *S = (1.0-w)*beq->S_of_lr[lo] + w*beq->S_of_lr[hi];
+}
+
+//Composition at one point, for whichever of Y_e, temperature and entropy TOVola provides, on the current and the past timelevels.
+//Every placement path writes the composition through here, so the past levels are filled here rather than in TOVola_set_past_point.
+static inline void TOVola_set_composition_point(const int i3d, const CCTK_REAL TOVola_rho_baryon, const TOVola_gf_struct *restrict gf){
+  CCTK_REAL Y_e, S;
+  TOVola_beq_lookup(gf->beq, TOVola_rho_baryon, &Y_e, &S);
+  if (gf->Y_e) gf->Y_e[i3d] = Y_e;
+  if (gf->temperature) gf->temperature[i3d] = gf->beq->T;
+  if (gf->entropy) gf->entropy[i3d] = S;
+  for(int l=0; l<gf->num_past_levels; l++){
+    const TOVola_past_gf_struct *restrict past = &gf->past[l];
+    if (past->Y_e) past->Y_e[i3d] = Y_e;
+    if (past->temperature) past->temperature[i3d] = gf->beq->T;
+    if (past->entropy) past->entropy[i3d] = S;
+  }
+}
+
+//Inside the star: matter and metric from the interpolated profile.
+static inline void TOVola_set_interior_point(const int i3d, const CCTK_REAL TOVola_rho_energy, const CCTK_REAL TOVola_rho_baryon, const CCTK_REAL TOVola_P,
+                                             const CCTK_REAL TOVola_expnu, const CCTK_REAL TOVola_exp4phi, const TOVola_gf_struct *restrict gf){
+  gf->rho[i3d] = TOVola_rho_baryon;
+  gf->press[i3d] = TOVola_P;
+  // tiny number prevents 0/0.
+  gf->eps[i3d] = (TOVola_rho_energy / (TOVola_rho_baryon+1e-30)) - 1.0;
+  if (gf->eps[i3d]<0){gf->eps[i3d]=0.0;}
+  gf->alp[i3d] = pow(TOVola_expnu,0.5);//This is the lapse
+  gf->gxx[i3d] = TOVola_exp4phi;//This is the values for the metric in the coordinates we chose.
+  gf->gyy[i3d] = gf->gxx[i3d];
+  gf->gzz[i3d] = gf->gxx[i3d];
+  if (gf->beq) TOVola_set_composition_point(i3d, gf->rho[i3d], gf);
+  TOVola_set_past_point(i3d, gf);
+}
+
+//Outside the star: vacuum Schwarzschild in isotropic coordinates, with conformal factor psi = 1 + M/(2 r_iso).
+//This is the closed form of r_Schw = r_iso psi^2, alpha = sqrt(1-2M/r_Schw), g_ii = (r_Schw/r_iso)^2, without pow or sqrt.
+static inline void TOVola_set_exterior_point(const int i3d, const CCTK_REAL TOVola_r_iso, const CCTK_REAL TOVola_Mass, const TOVola_gf_struct *restrict gf){
+  const CCTK_REAL half_M_over_r = 0.5*TOVola_Mass/TOVola_r_iso;
+  const CCTK_REAL psi = 1.0 + half_M_over_r;
+  const CCTK_REAL psi2 = psi*psi;
+  gf->rho[i3d] = 0.0;
+  gf->press[i3d] = 0.0;
+  gf->eps[i3d] = 0.0;
+  gf->alp[i3d] = (1.0 - half_M_over_r)/psi; //Goes to Schwarschild
+  gf->gxx[i3d] = psi2*psi2;
+  gf->gyy[i3d] = gf->gxx[i3d];
+  gf->gzz[i3d] = gf->gxx[i3d];
+  if (gf->beq) TOVola_set_composition_point(i3d, gf->rho[i3d], gf);
+  TOVola_set_past_point(i3d, gf);
+}
+
+//The same for the ni points of one x-line starting at row, all known to be outside the star: branch-free and vectorized.
+static inline void TOVola_set_exterior_row(const int row, const int ni, const CCTK_REAL *restrict row_r_iso, const CCTK_REAL TOVola_Mass,
+                                           const TOVola_gf_struct *restrict gf){
+  CCTK_REAL *restrict rho = &gf->rho[row];
+  CCTK_REAL *restrict press = &gf->press[row];
+  CCTK_REAL *restrict eps = &gf->eps[row];
+  CCTK_REAL *restrict alp = &gf->alp[row];
+  CCTK_REAL *restrict gxx = &gf->gxx[row];
+  CCTK_REAL *restrict gyy = &gf->gyy[row];
+  CCTK_REAL *restrict gzz = &gf->gzz[row];
+#pragma omp simd
+  for(int i=0; i<ni; i++){
+    const CCTK_REAL half_M_over_r = 0.5*TOVola_Mass/row_r_iso[i];
+    const CCTK_REAL psi = 1.0 + half_M_over_r;
+    const CCTK_REAL psi2 = psi*psi;
+    rho[i] = 0.0;
+    press[i] = 0.0;
+    eps[i] = 0.0;
+    alp[i] = (1.0 - half_M_over_r)/psi;
+    gxx[i] = psi2*psi2;
+    gyy[i] = psi2*psi2;
+    gzz[i] = psi2*psi2;
+  }
+  for(int l=0; l<gf->num_past_levels; l++){
+    const TOVola_past_gf_struct *restrict past = &gf->past[l];
+    memset(&past->rho[row], 0, sizeof(CCTK_REAL) * ni);
+    memset(&past->eps[row], 0, sizeof(CCTK_REAL) * ni);
+    memcpy(&past->gxx[row], gxx, sizeof(CCTK_REAL) * ni);
+    memcpy(&past->gyy[row], gxx, sizeof(CCTK_REAL) * ni);
+    memcpy(&past->gzz[row], gxx, sizeof(CCTK_REAL) * ni);
+  }
+  if (gf->beq){
+    for(int i=row; i<row+ni; i++) TOVola_set_composition_point(i, 0.0, gf);}
+}
+
+//Fill one row with a constant. These arrays are written once and not read back during placement,
+//so non-temporal stores keep them from evicting the profile and the tile radii from cache.
+static inline void TOVola_stream_fill(CCTK_REAL *restrict a, const int n, const CCTK_REAL value){
+#if defined(_OPENMP) && _OPENMP >= 201811
+#pragma omp simd nontemporal(a)
+#else
+#pragma omp simd
+#endif
+  for(int i=0; i<n; i++){
+    a[i] = value;
+  }
+}
+
+//Everywhere: fields that do not depend on the profile, for the ni points of one x-line starting at row.
+static inline void TOVola_set_static_row(const int row, const int ni, const TOVola_gf_struct *restrict gf){
+  TOVola_stream_fill(&gf->betax[row], ni, 0.0);
+  TOVola_stream_fill(&gf->betay[row], ni, 0.0);
+  TOVola_stream_fill(&gf->betaz[row], ni, 0.0);
+  TOVola_stream_fill(&gf->gxy[row], ni, 0.0);
+  TOVola_stream_fill(&gf->gxz[row], ni, 0.0);
+  TOVola_stream_fill(&gf->gyz[row], ni, 0.0);
+  //Curvature is zero for our slice.
+  TOVola_stream_fill(&gf->kxx[row], ni, 0.0);
+  TOVola_stream_fill(&gf->kyy[row], ni, 0.0);
+  TOVola_stream_fill(&gf->kzz[row], ni, 0.0);
+  TOVola_stream_fill(&gf->kxy[row], ni, 0.0);
+  TOVola_stream_fill(&gf->kxz[row], ni, 0.0);
+  TOVola_stream_fill(&gf->kyz[row], ni, 0.0);
+  //velocities are zero: It is a static solution.
+  TOVola_stream_fill(&gf->vel_x[row], ni, 0.0);
+  TOVola_stream_fill(&gf->vel_y[row], ni, 0.0);
+  TOVola_stream_fill(&gf->vel_z[row], ni, 0.0);
+  TOVola_stream_fill(&gf->w_lorentz[row], ni, 1.0);
+  for(int l=0; l<gf->num_past_levels; l++){
+    const TOVola_past_gf_struct *restrict past = &gf->past[l];
+    TOVola_stream_fill(&past->gxy[row], ni, 0.0);
+    TOVola_stream_fill(&past->gxz[row], ni, 0.0);
+    TOVola_stream_fill(&past->gyz[row], ni, 0.0);
+    TOVola_stream_fill(&past->vel_x[row], ni, 0.0);
+    TOVola_stream_fill(&past->vel_y[row], ni, 0.0);
+    TOVola_stream_fill(&past->vel_z[row], ni, 0.0);
+    TOVola_stream_fill(&past->w_lorentz[row], ni, 1.0);
+  }
+}
+
+//Interior profile values at one radius with the configured interpolation method, ordered as TOVOLA_GRID_*.
+//cursor is a per-thread hunt cursor for radii visited in increasing order, or NULL to bisect.
+static inline void TOVola_interpolate_interior(const TOVola_ID_persist_struct *restrict TOVola_ID_persist, const CCTK_REAL TOVola_r_iso, int *restrict cursor,
+                                               const int Interpolation_Stencil, const int Max_Interpolation_Stencil, CCTK_REAL *restrict out){
+  if (TOVola_ID_persist->interp_method == TOVOLA_INTERP_CHEBYSHEV){
+    TOVola_Chebyshev_eval(&TOVola_ID_persist->cheb, TOVola_r_iso, out);
+    return;}
+  const int idx_mid = cursor ? TOVola_hunt_idx_finder(TOVola_r_iso, TOVola_ID_persist->numpoints_arr, TOVola_ID_persist->r_iso_arr, cursor)
+                             : TOVola_bisection_idx_finder(TOVola_r_iso, TOVola_ID_persist->numpoints_arr, TOVola_ID_persist->r_iso_arr);
+  if (TOVola_ID_persist->interp_method == TOVOLA_INTERP_HERMITE){
+    TOVola_TOV_interpolate_1D_Hermite(TOVola_r_iso, idx_mid, TOVola_ID_persist, out);
+    return;}
+  CCTK_REAL TOVola_M;
+  const int stencil = TOVola_ID_persist->stencil_arr ? TOVola_ID_persist->stencil_arr[idx_mid] : Interpolation_Stencil;
+  TOVola_TOV_interpolate_1D_stencil(TOVola_r_iso, idx_mid, stencil, Max_Interpolation_Stencil,
+                                    TOVola_ID_persist->numpoints_arr, TOVola_ID_persist->r_Schw_arr,
+                                    TOVola_ID_persist->rho_energy_arr, TOVola_ID_persist->rho_baryon_arr, TOVola_ID_persist->P_arr,
+                                    TOVola_ID_persist->M_arr, TOVola_ID_persist->expnu_arr, TOVola_ID_persist->exp4phi_arr,
+                                    TOVola_ID_persist->r_iso_arr, &out[TOVOLA_GRID_RHO_ENERGY], &out[TOVOLA_GRID_RHO_BARYON], &out[TOVOLA_GRID_P],
+                                    &TOVola_M, &out[TOVOLA_GRID_EXPNU], &out[TOVOLA_GRID_EXP4PHI]);
+}
+
+//Interpolate nb batched interior points and write them. The packed SIMD kernel is used for plain Lagrange; everything else goes lane by lane.
+static inline void TOVola_flush_batch(const int nb, const int *restrict batch_i3d, const CCTK_REAL *restrict batch_r_iso,
+                                      const TOVola_ID_persist_struct *restrict TOVola_ID_persist, const int Interpolation_Stencil,
+                                      const int Max_Interpolation_Stencil, const TOVola_gf_struct *restrict gf){
+  CCTK_REAL batch_rho_energy[TOVOLA_INTERP_BATCH], batch_rho_baryon[TOVOLA_INTERP_BATCH], batch_P[TOVOLA_INTERP_BATCH];
+  CCTK_REAL batch_expnu[TOVOLA_INTERP_BATCH], batch_exp4phi[TOVOLA_INTERP_BATCH];
+  if (TOVola_ID_persist->knots){
+    TOVola_TOV_interpolate_1D_batch(nb, batch_r_iso, Interpolation_Stencil, Max_Interpolation_Stencil,
+                                    TOVola_ID_persist->numpoints_arr, TOVola_ID_persist->r_iso_arr, TOVola_ID_persist->knots,
+                                    batch_rho_energy, batch_rho_baryon, batch_P, batch_expnu, batch_exp4phi);}
+  else {
+    for(int b=0; b<nb; b++){
+      CCTK_REAL TOVola_vals[TOVOLA_NUM_GRID_FIELDS];
+      TOVola_interpolate_interior(TOVola_ID_persist, batch_r_iso[b], NULL, Interpolation_Stencil, Max_Interpolation_Stencil, TOVola_vals);
+      batch_rho_energy[b] = TOVola_vals[TOVOLA_GRID_RHO_ENERGY];
+      batch_rho_baryon[b] = TOVola_vals[TOVOLA_GRID_RHO_BARYON];
+      batch_P[b] = TOVola_vals[TOVOLA_GRID_P];
+      batch_expnu[b] = TOVola_vals[TOVOLA_GRID_EXPNU];
+      batch_exp4phi[b] = TOVola_vals[TOVOLA_GRID_EXP4PHI];}}
+  for(int b=0; b<nb; b++){
+    TOVola_set_interior_point(batch_i3d[b], batch_rho_energy[b], batch_rho_baryon[b], batch_P[b], batch_expnu[b], batch_exp4phi[b], gf);}
+}
+
+//Where the coordinate box [lo, hi] lies relative to the surface r_iso = Rbar of a star centered at center.
+//The margin keeps round-off in the per-point radii from turning a reported exterior or interior box into a straddling one.
+static inline int TOVola_box_region(const CCTK_REAL *restrict lo, const CCTK_REAL *restrict hi, const CCTK_REAL *restrict center, const CCTK_REAL TOVola_Rbar){
+  CCTK_REAL r2_min = 0.0, r2_max = 0.0;
+  for(int d=0; d<3; d++){
+    const CCTK_REAL l = lo[d]-center[d], h = hi[d]-center[d];
+    const CCTK_REAL nearest = l > 0.0 ? l : (h < 0.0 ? h : 0.0);
+    const CCTK_REAL farthest = MAX(fabs(l), fabs(h));
+    r2_min += nearest*nearest;
+    r2_max += farthest*farthest;
+  }
+  if (sqrt(r2_min) > TOVola_Rbar*(1.0+1e-12)) return TOVOLA_REGION_EXTERIOR;
+  if (sqrt(r2_max) < TOVola_Rbar*(1.0-1e-12)) return TOVOLA_REGION_INTERIOR;
+  return TOVOLA_REGION_STRADDLING;
+}
+
+//Whether the stars need the superposed path: more than one, or one that is not at the origin.
+static inline int TOVola_stars_superposed(const TOVola_star_struct *restrict stars, const int num_stars){
+  return num_stars > 1 || stars[0].center[0] != 0.0 || stars[0].center[1] != 0.0 || stars[0].center[2] != 0.0;
+}
+
+//Several stars: one tile of the superposed fields. Each star adds its deviation from flat space,
+//alpha = 1 + sum_s (alpha_s - 1) and g_ii = 1 + sum_s (g_ii^s - 1), and the matter is that of the densest star at the point.
+//A star's profile is only interpolated at points inside it. Elsewhere it contributes its closed-form exterior,
+//with a vectorized loop over whole rows when the tile lies entirely outside that star.
+static void TOVola_fill_tile_superposed(const TOVola_patch_struct *restrict patch, const TOVola_star_struct *restrict stars, const int num_stars,
+                                        const int Interpolation_Stencil, const int Max_Interpolation_Stencil, const int k, const int jt){
+  const TOVola_gf_struct *restrict gf = &patch->gf;
+  const CCTK_REAL *restrict x = patch->x, *restrict y = patch->y, *restrict z = patch->z;
+  const int ni = patch->lsh[0];
+  const int j0 = jt*TOVOLA_TILE_J;
+  const int j1 = MIN(j0+TOVOLA_TILE_J, patch->lsh[1]);
+  const int c0 = TOVOLA_PATCH_INDEX(patch,0,j0,k), c1 = TOVOLA_PATCH_INDEX(patch,ni-1,j1-1,k);
+  const CCTK_REAL lo[3] = {MIN(x[c0],x[c1]), MIN(y[c0],y[c1]), MIN(z[c0],z[c1])};
+  const CCTK_REAL hi[3] = {MAX(x[c0],x[c1]), MAX(y[c0],y[c1]), MAX(z[c0],z[c1])};
+
+  //Start from vacuum flat space; the rows accumulate the contributions of the stars.
+  for(int j=j0; j<j1; j++){
+    const int row = TOVOLA_PATCH_INDEX(patch,0,j,k);
+    memset(&gf->rho[row], 0, sizeof(CCTK_REAL) * ni);
+    memset(&gf->press[row], 0, sizeof(CCTK_REAL) * ni);
+    memset(&gf->eps[row], 0, sizeof(CCTK_REAL) * ni);
+    for(int i=row; i<row+ni; i++){
+      gf->alp[i] = 1.0;
+      gf->gxx[i] = 1.0;}
+  }
+
+  for(int s=0; s<num_stars; s++){
+    const TOVola_ID_persist_struct *restrict TOVola_ID_persist = stars[s].profile;
+    const CCTK_REAL TOVola_Rbar = TOVola_ID_persist->r_iso_arr[TOVola_ID_persist->numpoints_arr-1];
+    const CCTK_REAL TOVola_Mass = TOVola_ID_persist->M_arr[TOVola_ID_persist->numpoints_arr-1];
+    const CCTK_REAL x0 = stars[s].center[0], y0 = stars[s].center[1], z0 = stars[s].center[2];
+    const int tile_region = TOVola_box_region(lo, hi, stars[s].center, TOVola_Rbar);
+    for(int j=j0; j<j1; j++){
+      const int row = TOVOLA_PATCH_INDEX(patch,0,j,k);
+      CCTK_REAL *restrict rho = &gf->rho[row];
+      CCTK_REAL *restrict press = &gf->press[row];
+      CCTK_REAL *restrict eps = &gf->eps[row];
+      CCTK_REAL *restrict alp = &gf->alp[row];
+      CCTK_REAL *restrict gxx = &gf->gxx[row];
+      if (tile_region == TOVOLA_REGION_EXTERIOR){
+#pragma omp simd
+        for(int i=0; i<ni; i++){
+          const CCTK_REAL dx = x[row+i]-x0, dy = y[row+i]-y0, dz = z[row+i]-z0;
+          const CCTK_REAL half_M_over_r = 0.5*TOVola_Mass/sqrt(dx*dx+dy*dy+dz*dz);
+          const CCTK_REAL psi = 1.0 + half_M_over_r;
+          const CCTK_REAL psi2 = psi*psi;
+          alp[i] += (1.0 - half_M_over_r)/psi - 1.0;
+          gxx[i] += psi2*psi2 - 1.0;
+        }
+        continue;}
+      for(int i=0; i<ni; i++){
+        const CCTK_REAL dx = x[row+i]-x0, dy = y[row+i]-y0, dz = z[row+i]-z0;
+        const CCTK_REAL TOVola_r_iso = sqrt(dx*dx+dy*dy+dz*dz);
+        if (tile_region == TOVOLA_REGION_INTERIOR || TOVola_r_iso < TOVola_Rbar){
+          CCTK_REAL TOVola_vals[TOVOLA_NUM_GRID_FIELDS];
+          TOVola_interpolate_interior(TOVola_ID_persist, TOVola_r_iso, NULL, Interpolation_Stencil, Max_Interpolation_Stencil, TOVola_vals);
+          alp[i] += pow(TOVola_vals[TOVOLA_GRID_EXPNU],0.5) - 1.0;
+          gxx[i] += TOVola_vals[TOVOLA_GRID_EXP4PHI] - 1.0;
+          if (TOVola_vals[TOVOLA_GRID_RHO_BARYON] > rho[i]){
+            rho[i] = TOVola_vals[TOVOLA_GRID_RHO_BARYON];
+            press[i] = TOVola_vals[TOVOLA_GRID_P];
+            // tiny number prevents 0/0.
+            eps[i] = (TOVola_vals[TOVOLA_GRID_RHO_ENERGY] / (TOVola_vals[TOVOLA_GRID_RHO_BARYON]+1e-30)) - 1.0;
+            if (eps[i]<0){eps[i]=0.0;}}}
+        else {
+          const CCTK_REAL half_M_over_r = 0.5*TOVola_Mass/TOVola_r_iso;
+          const CCTK_REAL psi = 1.0 + half_M_over_r;
+          const CCTK_REAL psi2 = psi*psi;
+          alp[i] += (1.0 - half_M_over_r)/psi - 1.0;
+          gxx[i] += psi2*psi2 - 1.0;}
+      }
+    }
+  }
+
+  for(int j=j0; j<j1; j++){
+    const int row = TOVOLA_PATCH_INDEX(patch,0,j,k);
+    for(int i3d=row; i3d<row+ni; i3d++){
+      gf->gyy[i3d] = gf->gxx[i3d];
+      gf->gzz[i3d] = gf->gxx[i3d];
+      if (gf->beq) TOVola_set_composition_point(i3d, gf->rho[i3d], gf);
+      TOVola_set_past_point(i3d, gf);}
+  }
+}
+
+//Memoized placement needs a uniform patch whose points sit on a lattice of spacing dx/2 through the origin,
+//so that r^2 in units of (dx/2)^2 is an exact integer key shared by all symmetric points.
+//Returns that half spacing, or 0 if the patch does not qualify.
+static CCTK_REAL TOVola_lattice_half_spacing(const TOVola_patch_struct *restrict patch){
+  if (patch->lsh[0] < 2 || patch->lsh[1] < 2 || patch->lsh[2] < 2) return 0.0;
+  const CCTK_REAL *restrict x = patch->x, *restrict y = patch->y, *restrict z = patch->z;
+  const int i0 = TOVOLA_PATCH_INDEX(patch,0,0,0);
+  const CCTK_REAL dx = x[TOVOLA_PATCH_INDEX(patch,1,0,0)] - x[i0];
+  const CCTK_REAL dy = y[TOVOLA_PATCH_INDEX(patch,0,1,0)] - y[i0];
+  const CCTK_REAL dz = z[TOVOLA_PATCH_INDEX(patch,0,0,1)] - z[i0];
+  if (!(dx > 0) || fabs(dy-dx) > 1e-10*dx || fabs(dz-dx) > 1e-10*dx) return 0.0;
+  const CCTK_REAL h = 0.5*dx;
+  const CCTK_REAL corner[3] = {x[i0], y[i0], z[i0]};
+  for(int d=0; d<3; d++){
+    if (fabs(corner[d]/h - round(corner[d]/h)) > 1e-6) return 0.0;
+  }
+  return h;
+}
+
+//One tile of the engine: rows j in [jt*TOVOLA_TILE_J, (jt+1)*TOVOLA_TILE_J) of plane k, with tile_r_iso as scratch for their radii.
+//Every point outside the star is written here; interior points are handled according to fill_mode.
+//The constant fields are not touched: see TOVola_spawn_static_tasks.
+//If r_iso_all is given, the radius of every point is stored in it for later passes.
+//Except in superposed mode, stars holds the single star, at the origin.
+static void TOVola_fill_tile(const TOVola_patch_struct *restrict patch, const TOVola_star_struct *restrict stars, const int num_stars, const int fill_mode,
+                             const int Interpolation_Stencil, const int Max_Interpolation_Stencil, const int k, const int jt,
+                             CCTK_REAL *restrict tile_r_iso, CCTK_REAL *restrict r_iso_all){
+  if (fill_mode == TOVOLA_FILL_SUPERPOSED){
+    TOVola_fill_tile_superposed(patch, stars, num_stars, Interpolation_Stencil, Max_Interpolation_Stencil, k, jt);
+    return;}
+  const TOVola_ID_persist_struct *restrict TOVola_ID_persist = stars[0].profile;
+  const CCTK_REAL TOVola_Rbar = TOVola_ID_persist->r_iso_arr[TOVola_ID_persist->numpoints_arr-1];
+  const CCTK_REAL TOVola_Mass = TOVola_ID_persist->M_arr[TOVola_ID_persist->numpoints_arr-1];
+  const TOVola_gf_struct *restrict gf = &patch->gf;
+  const CCTK_REAL *restrict x = patch->x, *restrict y = patch->y, *restrict z = patch->z;
+  const int ni = patch->lsh[0];
+  const int j0 = jt*TOVOLA_TILE_J;
+  const int j1 = MIN(j0+TOVOLA_TILE_J, patch->lsh[1]);
+
+  //Sweep 1: radii of the tile, and where the tile lies relative to the surface.
+  CCTK_REAL tile_r_min = 1e300, tile_r_max = 0.0;
+  for(int j=j0; j<j1; j++){
+    CCTK_REAL *restrict row_r_iso = &tile_r_iso[(j-j0)*ni];
+    const int row = TOVOLA_PATCH_INDEX(patch,0,j,k);
+#pragma omp simd reduction(min:tile_r_min) reduction(max:tile_r_max)
+    for(int i=0; i<ni; i++){
+      row_r_iso[i] = sqrt((x[row+i]*x[row+i])+(y[row+i]*y[row+i])+(z[row+i]*z[row+i])); //magnitude of r on the grid
+      tile_r_min = MIN(tile_r_min, row_r_iso[i]);
+      tile_r_max = MAX(tile_r_max, row_r_iso[i]);
+    }
+    if (r_iso_all) memcpy(&r_iso_all[row], row_r_iso, sizeof(CCTK_REAL) * ni);
+  }
+  const int tile_region = !(tile_r_min < TOVola_Rbar) ? TOVOLA_REGION_EXTERIOR
+                        : (tile_r_max < TOVola_Rbar ? TOVOLA_REGION_INTERIOR : TOVOLA_REGION_STRADDLING);
+
+  //Sweep 2: the profile-dependent fields. Only tiles that straddle the surface test every point.
+  for(int j=j0; j<j1; j++){
+    const CCTK_REAL *restrict row_r_iso = &tile_r_iso[(j-j0)*ni];
+    const int row = TOVOLA_PATCH_INDEX(patch,0,j,k);
+    if (tile_region == TOVOLA_REGION_EXTERIOR){
+      TOVola_set_exterior_row(row, ni, row_r_iso, TOVola_Mass, gf);
+      continue;}
+    int batch_i3d[TOVOLA_INTERP_BATCH];
+    CCTK_REAL batch_r_iso[TOVOLA_INTERP_BATCH];
+    int nb = 0;
+    for(int i=0; i<ni; i++){
+      const int i3d = row+i;
+      const CCTK_REAL TOVola_r_iso = row_r_iso[i];
+      if (tile_region == TOVOLA_REGION_INTERIOR || TOVola_r_iso < TOVola_Rbar){ //If we are INSIDE the star, we need to interpollate the data to the grid.
+        if (fill_mode == TOVOLA_FILL_POINTWISE){
+          CCTK_REAL TOVola_vals[TOVOLA_NUM_GRID_FIELDS]; //TOV quantities, ordered as TOVOLA_GRID_*
+          TOVola_interpolate_interior(TOVola_ID_persist, TOVola_r_iso, NULL, Interpolation_Stencil, Max_Interpolation_Stencil, TOVola_vals);
+          TOVola_set_interior_point(i3d, TOVola_vals[TOVOLA_GRID_RHO_ENERGY], TOVola_vals[TOVOLA_GRID_RHO_BARYON], TOVola_vals[TOVOLA_GRID_P],
+                                    TOVola_vals[TOVOLA_GRID_EXPNU], TOVola_vals[TOVOLA_GRID_EXP4PHI], gf);}
+        else if (fill_mode == TOVOLA_FILL_BATCHED){
+          batch_i3d[nb] = i3d;
+          batch_r_iso[nb] = TOVola_r_iso;
+          nb++;
+          if (nb == TOVOLA_INTERP_BATCH){
+            TOVola_flush_batch(nb, batch_i3d, batch_r_iso, TOVola_ID_persist, Interpolation_Stencil, Max_Interpolation_Stencil, gf);
+            nb = 0;}}}
+      else { //If we are OUTSIDE the star, we need to calculate the grid functions directly. Thank you, Schwarzchild.
+        TOVola_set_exterior_point(i3d, TOVola_r_iso, TOVola_Mass, gf);}
+    }
+    if (nb > 0) TOVola_flush_batch(nb, batch_i3d, batch_r_iso, TOVola_ID_persist, Interpolation_Stencil, Max_Interpolation_Stencil, gf);
+  }
+}
+
+//The tile engine for one patch, with all threads.
+static void TOVola_fill_tiles(const TOVola_patch_struct *restrict patch, const TOVola_star_struct *restrict stars, const int num_stars, const int fill_mode,
+                              const int Interpolation_Stencil, const int Max_Interpolation_Stencil, CCTK_REAL *restrict r_iso_all){
+  const int ntiles_j = (patch->lsh[1] + TOVOLA_TILE_J - 1) / TOVOLA_TILE_J;
+#pragma omp parallel
+  {
+    CCTK_REAL *restrict tile_r_iso = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * TOVOLA_TILE_J * patch->lsh[0]);
+    if (!tile_r_iso) CCTK_ERROR("Memory allocation failed for the TOVola grid tile.\n");
+
+    //Static: the same thread always gets the same (k, tile) pairs, in every pass, so pages stay with the thread that first touched them.
+#pragma omp for collapse(2) schedule(static)
+    for(int k=0; k<patch->lsh[2]; k++){
+      for(int jt=0; jt<ntiles_j; jt++){
+        TOVola_fill_tile(patch, stars, num_stars, fill_mode, Interpolation_Stencil, Max_Interpolation_Stencil, k, jt, tile_r_iso, r_iso_all);
+      }
+    }
+    free(tile_r_iso);
+  }
+}
+
+//Per-thread radii buffer of the tile tasks, allocated by TOVola_fill_patches for the length of its parallel region.
+//Tile tasks are tied and contain no scheduling points, so each runs to completion on the thread whose buffer it uses.
+static CCTK_REAL *TOVola_task_tile_r_iso = NULL;
+#pragma omp threadprivate(TOVola_task_tile_r_iso)
+
+//The tile engine for one patch as tasks, queued without waiting. Used when many patches are filled together.
+static void TOVola_spawn_tile_tasks(const TOVola_patch_struct *restrict patch, const TOVola_star_struct *restrict stars, const int num_stars, const int fill_mode,
+                                    const int Interpolation_Stencil, const int Max_Interpolation_Stencil, CCTK_REAL *restrict r_iso_all){
+  const int ntiles_j = (patch->lsh[1] + TOVOLA_TILE_J - 1) / TOVOLA_TILE_J;
+#pragma omp taskloop collapse(2) nogroup
+  for(int k=0; k<patch->lsh[2]; k++){
+    for(int jt=0; jt<ntiles_j; jt++){
+      TOVola_fill_tile(patch, stars, num_stars, fill_mode, Interpolation_Stencil, Max_Interpolation_Stencil, k, jt, TOVola_task_tile_r_iso, r_iso_all);
+    }
+  }
+}
+
+//Number of entries of a patch's linear index range, including any padding in i and j.
+static inline int TOVola_patch_size(const TOVola_patch_struct *restrict patch){
+  return patch->ash[0]*patch->ash[1]*patch->lsh[2];
+}
+
+//Radii of every point of a patch for the sorted and memoized passes. Padding, which the tile engine never visits, is marked as exterior.
+static CCTK_REAL *TOVola_alloc_patch_radii(const TOVola_patch_struct *restrict patch){
+  const int npoints = TOVola_patch_size(patch);
+  CCTK_REAL *restrict r_iso_all = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * npoints);
+  if (r_iso_all && (patch->ash[0] != patch->lsh[0] || patch->ash[1] != patch->lsh[1])){
+    for(int i3d=0; i3d<npoints; i3d++) r_iso_all[i3d] = HUGE_VAL;}
+  return r_iso_all;
+}
+
+//Sorted placement: interior points are sorted by radius and the profile is swept once. Each thread hunts from where its previous point left off.
+static int TOVola_place_sorted(const TOVola_patch_struct *restrict patch, const CCTK_REAL *restrict r_iso_all, const TOVola_ID_persist_struct *restrict TOVola_ID_persist,
+                               const int Interpolation_Stencil, const int Max_Interpolation_Stencil){
+  const TOVola_gf_struct *restrict gf = &patch->gf;
+  const int npoints = TOVola_patch_size(patch);
+  const CCTK_REAL TOVola_Rbar = TOVola_ID_persist->r_iso_arr[TOVola_ID_persist->numpoints_arr-1];
+  CCTK_REAL *restrict interior_r_iso = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * npoints);
+  CCTK_REAL *restrict sorted_r_iso = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * npoints);
+  int *restrict interior_i3d = (int *restrict)malloc(sizeof(int) * npoints);
+  int *restrict sorted_i3d = (int *restrict)malloc(sizeof(int) * npoints);
+  int *restrict order = (int *restrict)malloc(sizeof(int) * npoints);
+  int *restrict bin_start = (int *restrict)malloc(sizeof(int) * (npoints+1));
+  if (!interior_r_iso || !sorted_r_iso || !interior_i3d || !sorted_i3d || !order || !bin_start) {
+    free(interior_r_iso); free(sorted_r_iso); free(interior_i3d); free(sorted_i3d); free(order); free(bin_start);
+    return 1;
+  }
+
+  int ninterior = 0;
+  for(int i3d=0; i3d<npoints; i3d++){
+    if (r_iso_all[i3d] < TOVola_Rbar){
+      interior_i3d[ninterior] = i3d;
+      interior_r_iso[ninterior] = r_iso_all[i3d];
+      ninterior++;}
+  }
+  TOVola_bin_by_radius(ninterior, interior_r_iso, TOVola_Rbar, order, bin_start);
+#pragma omp parallel for
+  for(int p=0; p<ninterior; p++){
+    sorted_r_iso[p] = interior_r_iso[order[p]];
+    sorted_i3d[p] = interior_i3d[order[p]];
+  }
+
+  //Static schedule: every thread gets one contiguous radial shell and streams through its part of the profile.
+#pragma omp parallel
+  {
+    int cursor = -1;
+#pragma omp for schedule(static)
+    for(int p=0; p<ninterior; p++){
+      CCTK_REAL TOVola_vals[TOVOLA_NUM_GRID_FIELDS];
+      TOVola_interpolate_interior(TOVola_ID_persist, sorted_r_iso[p], &cursor, Interpolation_Stencil, Max_Interpolation_Stencil, TOVola_vals);
+      TOVola_set_interior_point(sorted_i3d[p], TOVola_vals[TOVOLA_GRID_RHO_ENERGY], TOVola_vals[TOVOLA_GRID_RHO_BARYON], TOVola_vals[TOVOLA_GRID_P],
+                                TOVola_vals[TOVOLA_GRID_EXPNU], TOVola_vals[TOVOLA_GRID_EXP4PHI], gf);
+    }
+  }
+
+  free(interior_r_iso);
+  free(sorted_r_iso);
+  free(interior_i3d);
+  free(sorted_i3d);
+  free(order);
+  free(bin_start);
+  return 0;
+}
+
+//Memoized placement. Spherical symmetry: every interior point is keyed by the integer (r/h)^2, with h half the grid spacing.
+//Each distinct key is interpolated once, in increasing radius with a hunt cursor, and scattered to all points sharing it.
+//The number of distinct radii is returned in ndistinct_out.
+static int TOVola_place_memoized(const TOVola_patch_struct *restrict patch, const CCTK_REAL *restrict r_iso_all, const CCTK_REAL lattice_h,
+                                 const TOVola_ID_persist_struct *restrict TOVola_ID_persist,
+                                 const int Interpolation_Stencil, const int Max_Interpolation_Stencil, int *restrict ndistinct_out){
+  const TOVola_gf_struct *restrict gf = &patch->gf;
+  const CCTK_REAL *restrict x = patch->x, *restrict y = patch->y, *restrict z = patch->z;
+  const int npoints = TOVola_patch_size(patch);
+  const CCTK_REAL TOVola_Rbar = TOVola_ID_persist->r_iso_arr[TOVola_ID_persist->numpoints_arr-1];
+  int *restrict key = (int *restrict)malloc(sizeof(int) * npoints);
+  if (!key) return 1;
+
+  int max_key = -1;
+#pragma omp parallel for schedule(static) reduction(max:max_key)
+  for(int i3d=0; i3d<npoints; i3d++){
+    if (r_iso_all[i3d] < TOVola_Rbar){
+      const long a = lround(x[i3d]/lattice_h), b = lround(y[i3d]/lattice_h), c = lround(z[i3d]/lattice_h);
+      key[i3d] = (int)(a*a + b*b + c*c);
+      max_key = MAX(max_key, key[i3d]);}
+    else {
+      key[i3d] = -1;}
+  }
+
+  //Number the distinct keys in increasing order; the first point seen with each key supplies its radius.
+  int *restrict distinct_of_key = (int *restrict)malloc(sizeof(int) * (max_key+1));
+  CCTK_REAL *restrict distinct_r_iso = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * (max_key+1));
+  if (!distinct_of_key || !distinct_r_iso) {
+    free(key); free(distinct_of_key); free(distinct_r_iso);
+    return 1;
+  }
+  for(int q=0; q<=max_key; q++) distinct_of_key[q] = -1;
+  for(int i3d=0; i3d<npoints; i3d++){
+    if (key[i3d] >= 0 && distinct_of_key[key[i3d]] < 0){
+      distinct_of_key[key[i3d]] = 0;
+      distinct_r_iso[key[i3d]] = r_iso_all[i3d];}
+  }
+  int ndistinct = 0;
+  for(int q=0; q<=max_key; q++){
+    if (distinct_of_key[q] == 0){
+      distinct_r_iso[ndistinct] = distinct_r_iso[q];
+      distinct_of_key[q] = ndistinct++;}
+  }
+  *ndistinct_out = ndistinct;
+
+  CCTK_REAL *restrict memo = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * TOVOLA_NUM_GRID_FIELDS * (ndistinct+1));
+  if (!memo) {
+    free(key); free(distinct_of_key); free(distinct_r_iso);
+    return 1;
+  }
+#pragma omp parallel
+  {
+    int cursor = -1;
+#pragma omp for schedule(static)
+    for(int d=0; d<ndistinct; d++){
+      TOVola_interpolate_interior(TOVola_ID_persist, distinct_r_iso[d], &cursor, Interpolation_Stencil, Max_Interpolation_Stencil,
+                                  &memo[TOVOLA_NUM_GRID_FIELDS*d]);
+    }
+  }
+
+#pragma omp parallel for schedule(static)
+  for(int i3d=0; i3d<npoints; i3d++){
+    if (key[i3d] >= 0){
+      const CCTK_REAL *restrict m = &memo[TOVOLA_NUM_GRID_FIELDS*distinct_of_key[key[i3d]]];
+      TOVola_set_interior_point(i3d, m[TOVOLA_GRID_RHO_ENERGY], m[TOVOLA_GRID_RHO_BARYON], m[TOVOLA_GRID_P], m[TOVOLA_GRID_EXPNU], m[TOVOLA_GRID_EXP4PHI], gf);}
+  }
+
+  free(key);
+  free(distinct_of_key);
+  free(distinct_r_iso);
+  free(memo);
+  return 0;
+}
+
+//Queue the constant fields of a patch as tasks, in the same (k, tile) units as the tile engine, and return without waiting.
+//They complete at the next barrier of the enclosing parallel region.
+static void TOVola_spawn_static_tasks(const TOVola_patch_struct *restrict patch){
+  const int ni = patch->lsh[0];
+  const int ntiles_j = (patch->lsh[1] + TOVOLA_TILE_J - 1) / TOVOLA_TILE_J;
+#pragma omp taskloop collapse(2) nogroup
+  for(int k=0; k<patch->lsh[2]; k++){
+    for(int jt=0; jt<ntiles_j; jt++){
+      const int j1 = MIN((jt+1)*TOVOLA_TILE_J, patch->lsh[1]);
+      for(int j=jt*TOVOLA_TILE_J; j<j1; j++){
+        TOVola_set_static_row(TOVOLA_PATCH_INDEX(patch,0,j,k), ni, &patch->gf);
+      }
+    }
+  }
+}
+
+//Where the patch lies relative to the surface at r_iso = Rbar, from the radial extent of its coordinate bounding box.
+static int TOVola_classify_patch(const TOVola_patch_struct *restrict patch, const CCTK_REAL TOVola_Rbar){
+  const CCTK_REAL *restrict x = patch->x, *restrict y = patch->y, *restrict z = patch->z;
+  const int i0 = TOVOLA_PATCH_INDEX(patch,0,0,0);
+  const int i1 = TOVOLA_PATCH_INDEX(patch,patch->lsh[0]-1,patch->lsh[1]-1,patch->lsh[2]-1);
+  const CCTK_REAL lo[3] = {MIN(x[i0],x[i1]), MIN(y[i0],y[i1]), MIN(z[i0],z[i1])};
+  const CCTK_REAL hi[3] = {MAX(x[i0],x[i1]), MAX(y[i0],y[i1]), MAX(z[i0],z[i1])};
+  const CCTK_REAL origin[3] = {0.0, 0.0, 0.0};
+  return TOVola_box_region(lo, hi, origin, TOVola_Rbar);
+}
+
+//How the tile engine treats the interior of one patch under the requested placement.
+//Patches entirely outside the star (most outer refinement levels) never touch the profile; every tile takes the exterior kernel.
+//lattice_h is set for memoized placement, and left 0 when memoized falls back to sorted.
+static int TOVola_patch_fill_mode(const TOVola_patch_struct *restrict patch, const CCTK_REAL TOVola_Rbar, const char *grid_placement, CCTK_REAL *restrict lattice_h){
+  *lattice_h = 0.0;
+  if (TOVola_classify_patch(patch, TOVola_Rbar) == TOVOLA_REGION_EXTERIOR) return TOVOLA_FILL_POINTWISE;
+  if(CCTK_EQUALS("pointwise",grid_placement)) return TOVOLA_FILL_POINTWISE;
+  if(CCTK_EQUALS("batched",grid_placement)) return TOVOLA_FILL_BATCHED;
+  if(CCTK_EQUALS("memoized",grid_placement)){
+    *lattice_h = TOVola_lattice_half_spacing(patch);
+    if (*lattice_h == 0.0){
+      CCTK_INFO("Grid patch is not a uniform lattice through the origin; using sorted placement instead of memoized.");}
+  }
+  return TOVOLA_FILL_DEFERRED;
+}
+
+//The packed knots feed the SIMD kernel of batched placement; only plain Lagrange uses it.
+static int TOVola_prepare_batched(TOVola_ID_persist_struct *restrict TOVola_ID_persist){
+  if (TOVola_ID_persist->interp_method == TOVOLA_INTERP_LAGRANGE && !TOVola_ID_persist->stencil_arr && !TOVola_ID_persist->knots) return TOVola_pack_knots(TOVola_ID_persist);
+  return 0;
+}
+
+//Put the stars on one patch with the requested placement, using all threads. Returns nonzero on allocation failure.
+static int TOVola_fill_grid(const TOVola_patch_struct *restrict patch, const TOVola_star_struct *restrict stars, const int num_stars, const char *grid_placement,
+                            const int Interpolation_Stencil, const int Max_Interpolation_Stencil){
+  if (TOVola_stars_superposed(stars, num_stars)){
+    TOVola_fill_tiles(patch, stars, num_stars, TOVOLA_FILL_SUPERPOSED, Interpolation_Stencil, Max_Interpolation_Stencil, NULL);
+    return 0;}
+  TOVola_ID_persist_struct *restrict TOVola_ID_persist = stars[0].profile;
+  const CCTK_REAL TOVola_Rbar = TOVola_ID_persist->r_iso_arr[TOVola_ID_persist->numpoints_arr-1];
+  CCTK_REAL lattice_h;
+  const int fill_mode = TOVola_patch_fill_mode(patch, TOVola_Rbar, grid_placement, &lattice_h);
+  if (fill_mode == TOVOLA_FILL_BATCHED && TOVola_prepare_batched(TOVola_ID_persist) != 0) return 1;
+  if (fill_mode != TOVOLA_FILL_DEFERRED){
+    TOVola_fill_tiles(patch, stars, num_stars, fill_mode, Interpolation_Stencil, Max_Interpolation_Stencil, NULL);
+    return 0;}
+
+  //Sorted and memoized placement: the tile engine writes the exterior and keeps all radii for the interior pass.
+  CCTK_REAL *restrict r_iso_all = TOVola_alloc_patch_radii(patch);
+  if (!r_iso_all) return 1;
+  TOVola_fill_tiles(patch, stars, num_stars, fill_mode, Interpolation_Stencil, Max_Interpolation_Stencil, r_iso_all);
+  int retval;
+  if (lattice_h > 0.0){
+    int ndistinct = 0;
+    retval = TOVola_place_memoized(patch, r_iso_all, lattice_h, TOVola_ID_persist, Interpolation_Stencil, Max_Interpolation_Stencil, &ndistinct);
+    if (!retval) CCTK_VINFO("Memoized placement: %d distinct radii for %d grid points.", ndistinct, patch->lsh[0]*patch->lsh[1]*patch->lsh[2]);}
+  else {
+    retval = TOVola_place_sorted(patch, r_iso_all, TOVola_ID_persist, Interpolation_Stencil, Max_Interpolation_Stencil);}
+  free(r_iso_all);
+  return retval;
+}
+
+//Put the stars on many patches at once, typically all local Carpet components of a refinement level.
+//All tiles of all patches are queued as tasks, so threads stay busy even when each component is small.
+//The interior passes of sorted and memoized patches follow, one patch at a time, each with its own parallel loops over all threads
+//(inside a task they would run on a team of one). Returns nonzero on allocation failure.
+static int TOVola_fill_patches(const int num_patches, const TOVola_patch_struct *restrict patches, const TOVola_star_struct *restrict stars, const int num_stars,
+                               const char *grid_placement, const int Interpolation_Stencil, const int Max_Interpolation_Stencil){
+  const int superposed = TOVola_stars_superposed(stars, num_stars);
+  TOVola_ID_persist_struct *restrict TOVola_ID_persist = stars[0].profile;
+  const CCTK_REAL TOVola_Rbar = TOVola_ID_persist->r_iso_arr[TOVola_ID_persist->numpoints_arr-1];
+  int *restrict fill_mode = (int *restrict)malloc(sizeof(int) * num_patches);
+  CCTK_REAL *restrict lattice_h = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * num_patches);
+  CCTK_REAL **r_iso_all = (CCTK_REAL **)calloc(num_patches, sizeof(CCTK_REAL *));
+  int failed = (!fill_mode || !lattice_h || !r_iso_all);
+  for(int p=0; p<num_patches && !failed; p++){
+    if (superposed){
+      fill_mode[p] = TOVOLA_FILL_SUPERPOSED;
+      lattice_h[p] = 0.0;
+      continue;}
+    fill_mode[p] = TOVola_patch_fill_mode(&patches[p], TOVola_Rbar, grid_placement, &lattice_h[p]);
+    if (fill_mode[p] == TOVOLA_FILL_BATCHED && TOVola_prepare_batched(TOVola_ID_persist) != 0) failed = 1;
+    if (fill_mode[p] == TOVOLA_FILL_DEFERRED && !(r_iso_all[p] = TOVola_alloc_patch_radii(&patches[p]))) failed = 1;
+  }
+
+  int ndistinct = 0, nmemoized = 0;
+  if (!failed){
+    int max_ni = 0;
+    for(int p=0; p<num_patches; p++) max_ni = MAX(max_ni, patches[p].lsh[0]);
+#pragma omp parallel
+    {
+      TOVola_task_tile_r_iso = (CCTK_REAL *)malloc(sizeof(CCTK_REAL) * TOVOLA_TILE_J * max_ni);
+      if (!TOVola_task_tile_r_iso) CCTK_ERROR("Memory allocation failed for the TOVola grid tile.\n");
+#pragma omp single
+      {
+#pragma omp taskgroup
+        {
+          for(int p=0; p<num_patches; p++){
+            TOVola_spawn_tile_tasks(&patches[p], stars, num_stars, fill_mode[p], Interpolation_Stencil, Max_Interpolation_Stencil, r_iso_all[p]);
+          }
+        }
+      }
+      free(TOVola_task_tile_r_iso); //The single waits for all tasks
+      TOVola_task_tile_r_iso = NULL;
+    }
+    for(int p=0; p<num_patches && !failed; p++){
+      if (!r_iso_all[p]) continue;
+      if (lattice_h[p] > 0.0){
+        int nd = 0;
+        failed = TOVola_place_memoized(&patches[p], r_iso_all[p], lattice_h[p], TOVola_ID_persist, Interpolation_Stencil, Max_Interpolation_Stencil, &nd);
+        ndistinct += nd;
+        nmemoized++;}
+      else {
+        failed = TOVola_place_sorted(&patches[p], r_iso_all[p], TOVola_ID_persist, Interpolation_Stencil, Max_Interpolation_Stencil);}
+    }
+    if (nmemoized > 0 && !failed) CCTK_VINFO("Memoized placement: %d distinct radii over %d components.", ndistinct, nmemoized);
+  }
+
+  if (r_iso_all){
+    for(int p=0; p<num_patches; p++) free(r_iso_all[p]);}
+  free(r_iso_all);
+  free(fill_mode);
+  free(lattice_h);
+  return failed;
+}
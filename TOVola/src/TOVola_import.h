@@ -0,0 +1,67 @@
+#pragma once
+
+//This header file reads an externally computed raw TOV profile into the solver arrays, in place of the integration. The columns
+//are those of NRml_TOV's ooData.txt: r_Schw, rho_energy, rho_baryon, P, M, nu, 2nu, r_iso, one sample per row, with nu and r_iso
+//not yet normalized. The "ASCII" format is that text file itself; the "binary" format holds the same 8 columns as rows of
+//CCTK_REALs in native byte order. The profile then goes through the same normalization as a solved one.
+
+#include "TOVola_defines.h"
+#include "TOVola_solve.h"
+#include <stdio.h>
+#include <string.h>
+
+#include <cctk.h>
+
+#define TOVOLA_IMPORT_NUM_COLUMNS 8
+
+//Append one row of the file to the raw arrays. Rows at r <= 0 are skipped: the mirrored samples at r < 0 cover the center, and
+//the first row of ooData.txt holds exp(nu) instead of nu.
+static void TOVola_import_row(TOVola_data_struct *TOVdata, const CCTK_REAL row[TOVOLA_IMPORT_NUM_COLUMNS], const char *path, const long line){
+  if (!(row[0] > 0)) return;
+  const int i = TOVdata->numpoints_actually_saved;
+  if (i > 0 && !(row[0] > TOVdata->rSchw_arr[i-1]))
+    CCTK_VERROR("The radii of the TOVola profile '%s' do not increase at row %ld.", path, line);
+  TOVola_reserve(TOVdata, i + 1);
+  TOVdata->rSchw_arr[i] = row[0];
+  TOVdata->rho_energy_arr[i] = row[1];
+  TOVdata->rho_baryon_arr[i] = row[2];
+  TOVdata->P_arr[i] = row[3];
+  TOVdata->M_arr[i] = row[4];
+  TOVdata->nu_arr[i] = row[5];
+  TOVdata->Iso_r_arr[i] = row[7];
+  TOVdata->numpoints_actually_saved = i + 1;
+}
+
+//Read the raw profile in path into TOVdata, which must not store derivatives. format is "ASCII" or "binary".
+static void TOVola_import_raw_profile(TOVola_data_struct *TOVdata, const char *path, const char *format){
+  const int binary = CCTK_EQUALS(format, "binary");
+  FILE *file = fopen(path, binary ? "rb" : "r");
+  if (!file) CCTK_VERROR("Could not open the TOVola profile '%s'.", path);
+
+  TOVdata->numpoints_actually_saved = 0;
+  TOVdata->num_rhs_evaluations = 0;
+  CCTK_REAL row[TOVOLA_IMPORT_NUM_COLUMNS];
+  long line = 0;
+  if (binary) {
+    while (fread(row, sizeof(CCTK_REAL), TOVOLA_IMPORT_NUM_COLUMNS, file) == TOVOLA_IMPORT_NUM_COLUMNS)
+      TOVola_import_row(TOVdata, row, path, ++line);
+    if (!feof(file)) CCTK_VERROR("The TOVola profile '%s' does not hold whole rows of %d values.", path, TOVOLA_IMPORT_NUM_COLUMNS);
+  }
+  else {
+    char buffer[1024];
+    while (fgets(buffer, sizeof(buffer), file)) {
+      line++;
+      if (buffer[strspn(buffer, " \t\r\n")] == '\0') continue; // Blank line
+      double d[TOVOLA_IMPORT_NUM_COLUMNS];
+      if (sscanf(buffer, "%lf %lf %lf %lf %lf %lf %lf %lf", &d[0], &d[1], &d[2], &d[3], &d[4], &d[5], &d[6], &d[7]) != TOVOLA_IMPORT_NUM_COLUMNS)
+        CCTK_VERROR("Line %ld of the TOVola profile '%s' does not hold %d numbers.", line, path, TOVOLA_IMPORT_NUM_COLUMNS);
+      for(int c=0; c<TOVOLA_IMPORT_NUM_COLUMNS; c++) row[c] = d[c];
+      TOVola_import_row(TOVdata, row, path, line);
+    }
+  }
+  fclose(file);
+
+  if (TOVdata->numpoints_actually_saved < 2)
+    CCTK_VERROR("The TOVola profile '%s' holds fewer than 2 samples at r > 0.", path);
+  TOVdata->central_baryon_density = TOVdata->rho_baryon_arr[0];
+}
@@ -49,6 +49,177 @@ static int TOVola_bisection_idx_finder(const CCTK_REAL rr_iso, const int numpoin
   CCTK_ERROR("Shutting down due to error...");
 }
 
+/* Hunt index finder: same result as TOVola_bisection_idx_finder, but starts from a cursor left by the previous
+   lookup. For radii visited in (nearly) increasing order the cursor only moves a few knots per call. */
+static int TOVola_hunt_idx_finder(const CCTK_REAL rr_iso, const int numpoints_arr, const CCTK_REAL *restrict r_iso_arr, int *restrict cursor) {
+  int x1 = *cursor;
+  if (x1 < 0 || x1 > numpoints_arr - 2) {
+    x1 = MAX(0, TOVola_bisection_idx_finder(rr_iso, numpoints_arr, r_iso_arr) - 1);
+  }
+  // Restore the bisection bracket r_iso_arr[x1] < rr_iso <= r_iso_arr[x1+1]
+  while (x1 > 0 && r_iso_arr[x1] >= rr_iso) {
+    x1--;
+  }
+  while (x1 < numpoints_arr - 2 && r_iso_arr[x1 + 1] < rr_iso) {
+    x1++;
+  }
+  *cursor = x1;
+  const int x2 = x1 + 1;
+  if (fabs(rr_iso - r_iso_arr[x1]) < fabs(rr_iso - r_iso_arr[x2])) {
+    return x1;
+  }
+  return x2;
+}
+
+/* Lagrange interpolation inside the star, with the central stencil index already known */
+static void TOVola_TOV_interpolate_1D_stencil(const CCTK_REAL rr_iso, const int idx_mid,
+                                              const int Interpolation_Stencil, const int Max_Interpolation_Stencil, const int numpoints_arr, const CCTK_REAL *restrict r_Schw_arr,
+                                              const CCTK_REAL *restrict rho_energy_arr, const CCTK_REAL *restrict rho_baryon_arr, const CCTK_REAL *restrict P_arr,
+                                              const CCTK_REAL *restrict M_arr, const CCTK_REAL *restrict expnu_arr, const CCTK_REAL *restrict exp4phi_arr,
+                                              const CCTK_REAL *restrict r_iso_arr, CCTK_REAL *restrict rho_energy, CCTK_REAL *restrict rho_baryon, CCTK_REAL *restrict P,
+                                              CCTK_REAL *restrict M, CCTK_REAL *restrict expnu, CCTK_REAL *restrict exp4phi) {
+
+  const int R_idx = numpoints_arr - 1;
+  CCTK_REAL r_Schw = 0.0;
+
+  /* Use standard library functions instead of redefining macros */
+  int idxmin = MAX(0, idx_mid - Interpolation_Stencil / 2 - 1);
+
+  // -= Do not allow the interpolation stencil to cross the star's surface =-
+  // max index is when idxmin + (TOVola_Interpolation_stencil-1) = R_idx
+  //  -> idxmin at most can be R_idx - TOVola_Interpolation_stencil + 1
+  idxmin = MIN(idxmin, R_idx - Interpolation_Stencil + 1);
+
+  // Ensure that Interpolation_Stencil does not exceed the maximum
+  if (Interpolation_Stencil > Max_Interpolation_Stencil) {
+    CCTK_ERROR("Interpolation stencil size exceeds maximum allowed.");
+  }
+
+  // Now perform the Lagrange polynomial interpolation:
+
+  // First compute the interpolation coefficients:
+  CCTK_REAL r_iso_sample[Max_Interpolation_Stencil];
+  for (int i = idxmin; i < idxmin + Interpolation_Stencil; i++) {
+    r_iso_sample[i - idxmin] = r_iso_arr[i];
+  }
+  CCTK_REAL l_i_of_r[Max_Interpolation_Stencil];
+  for (int i = 0; i < Interpolation_Stencil; i++) {
+    CCTK_REAL numer = 1.0;
+    CCTK_REAL denom = 1.0;
+    for (int j = 0; j < Interpolation_Stencil; j++) {
+      if (j != i) {
+        numer *= (rr_iso - r_iso_sample[j]);
+        denom *= (r_iso_sample[i] - r_iso_sample[j]);
+      }
+    }
+    l_i_of_r[i] = numer / denom;
+  }
+
+  // Then perform the interpolation:
+  *rho_energy = 0.0;
+  *rho_baryon = 0.0;
+  *P = 0.0;
+  *M = 0.0;
+  *expnu = 0.0;
+  *exp4phi = 0.0;
+
+  for (int i = idxmin; i < idxmin + Interpolation_Stencil; i++) {
+    r_Schw += l_i_of_r[i - idxmin] * r_Schw_arr[i];
+    *rho_energy += l_i_of_r[i - idxmin] * rho_energy_arr[i];
+    *rho_baryon += l_i_of_r[i - idxmin] * rho_baryon_arr[i];
+    *P += l_i_of_r[i - idxmin] * P_arr[i];
+    *M += l_i_of_r[i - idxmin] * M_arr[i];
+    *expnu += l_i_of_r[i - idxmin] * expnu_arr[i];
+    *exp4phi += l_i_of_r[i - idxmin] * exp4phi_arr[i];
+  }
+}
+
+/* Cubic Hermite interpolation inside the star from the two knots bracketing rr_iso and the stored d/dr_iso.
+   idx_mid is the nearest knot, as returned by the bisection or hunt finders. Output ordered as TOVOLA_GRID_*. */
+static void TOVola_TOV_interpolate_1D_Hermite(const CCTK_REAL rr_iso, const int idx_mid, const TOVola_ID_persist_struct *restrict TOVola_ID_persist,
+                                              CCTK_REAL *restrict out) {
+  const CCTK_REAL *restrict r_iso_arr = TOVola_ID_persist->r_iso_arr;
+  const int x1 = MAX(0, MIN(TOVola_ID_persist->numpoints_arr - 2, (r_iso_arr[idx_mid] > rr_iso) ? idx_mid - 1 : idx_mid));
+  const int x2 = x1 + 1;
+  const CCTK_REAL h = r_iso_arr[x2] - r_iso_arr[x1];
+  const CCTK_REAL t = (rr_iso - r_iso_arr[x1]) / h;
+  const CCTK_REAL t2 = t * t;
+  const CCTK_REAL t3 = t2 * t;
+  const CCTK_REAL h00 = 2.0 * t3 - 3.0 * t2 + 1.0;
+  const CCTK_REAL h10 = (t3 - 2.0 * t2 + t) * h;
+  const CCTK_REAL h01 = -2.0 * t3 + 3.0 * t2;
+  const CCTK_REAL h11 = (t3 - t2) * h;
+
+  const CCTK_REAL *restrict f[TOVOLA_NUM_GRID_FIELDS] = {TOVola_ID_persist->rho_energy_arr, TOVola_ID_persist->rho_baryon_arr, TOVola_ID_persist->P_arr,
+                                                         TOVola_ID_persist->expnu_arr, TOVola_ID_persist->exp4phi_arr};
+  const CCTK_REAL *restrict df[TOVOLA_NUM_GRID_FIELDS] = {TOVola_ID_persist->drho_energy_arr, TOVola_ID_persist->drho_baryon_arr, TOVola_ID_persist->dP_arr,
+                                                          TOVola_ID_persist->dexpnu_arr, TOVola_ID_persist->dexp4phi_arr};
+  for (int k = 0; k < TOVOLA_NUM_GRID_FIELDS; k++) {
+    out[k] = h00 * f[k][x1] + h10 * df[k][x1] + h01 * f[k][x2] + h11 * df[k][x2];
+  }
+}
+
+/* Smallest stencil the adaptive Lagrange mode will try */
+#define TOVOLA_MIN_ADAPTIVE_STENCIL 4
+
+/* Adaptive stencil selection: for each knot, compare the Lagrange interpolants of orders s and s+1 at the two
+   half-way points to its neighbours (the extremes of the points that pick this knot as idx_mid). The smallest s
+   whose difference stays below tolerance (relative to the maximum of each field over the profile) is recorded, up to
+   Interpolation_Stencil.
+   Returns the mean selected stencil, or -1 on allocation failure. */
+static CCTK_REAL TOVola_select_stencils(TOVola_ID_persist_struct *restrict TOVola_ID_persist, const int Interpolation_Stencil,
+                                       const int Max_Interpolation_Stencil, const CCTK_REAL tolerance) {
+  const int numpoints = TOVola_ID_persist->numpoints_arr;
+  TOVola_ID_persist->stencil_arr = (unsigned char *restrict)malloc(sizeof(unsigned char) * numpoints);
+  if (!TOVola_ID_persist->stencil_arr) {
+    return -1.0;
+  }
+  const CCTK_REAL *restrict r_iso_arr = TOVola_ID_persist->r_iso_arr;
+  const int s_min = MIN(TOVOLA_MIN_ADAPTIVE_STENCIL, Interpolation_Stencil);
+  long stencil_sum = 0;
+
+  // Relative to the local value, the test would demand ever higher orders towards the surface, where the densities vanish.
+  CCTK_REAL scale[TOVOLA_NUM_GRID_FIELDS] = {0};
+  for (int i = 0; i < numpoints; i++) {
+    scale[TOVOLA_GRID_RHO_ENERGY] = MAX(scale[TOVOLA_GRID_RHO_ENERGY], fabs(TOVola_ID_persist->rho_energy_arr[i]));
+    scale[TOVOLA_GRID_RHO_BARYON] = MAX(scale[TOVOLA_GRID_RHO_BARYON], fabs(TOVola_ID_persist->rho_baryon_arr[i]));
+    scale[TOVOLA_GRID_P] = MAX(scale[TOVOLA_GRID_P], fabs(TOVola_ID_persist->P_arr[i]));
+    scale[TOVOLA_GRID_EXPNU] = MAX(scale[TOVOLA_GRID_EXPNU], fabs(TOVola_ID_persist->expnu_arr[i]));
+    scale[TOVOLA_GRID_EXP4PHI] = MAX(scale[TOVOLA_GRID_EXP4PHI], fabs(TOVola_ID_persist->exp4phi_arr[i]));
+  }
+
+#pragma omp parallel for reduction(+:stencil_sum) schedule(static)
+  for (int idx = 0; idx < numpoints; idx++) {
+    int s_pick = Interpolation_Stencil;
+    for (int s = s_min; s < Interpolation_Stencil && s_pick == Interpolation_Stencil; s++) {
+      int ok = 1;
+      for (int side = -1; side <= 1 && ok; side += 2) {
+        const int nbr = idx + side;
+        if (nbr < 0 || nbr >= numpoints) continue;
+        const CCTK_REAL rr = 0.5 * (r_iso_arr[idx] + r_iso_arr[nbr]);
+        CCTK_REAL lo[TOVOLA_NUM_GRID_FIELDS], hi[TOVOLA_NUM_GRID_FIELDS], M; // M is not placed on the grid
+        TOVola_TOV_interpolate_1D_stencil(rr, idx, s, Max_Interpolation_Stencil, numpoints, TOVola_ID_persist->r_Schw_arr,
+                                          TOVola_ID_persist->rho_energy_arr, TOVola_ID_persist->rho_baryon_arr, TOVola_ID_persist->P_arr,
+                                          TOVola_ID_persist->M_arr, TOVola_ID_persist->expnu_arr, TOVola_ID_persist->exp4phi_arr, r_iso_arr,
+                                          &lo[TOVOLA_GRID_RHO_ENERGY], &lo[TOVOLA_GRID_RHO_BARYON], &lo[TOVOLA_GRID_P], &M,
+                                          &lo[TOVOLA_GRID_EXPNU], &lo[TOVOLA_GRID_EXP4PHI]);
+        TOVola_TOV_interpolate_1D_stencil(rr, idx, s + 1, Max_Interpolation_Stencil, numpoints, TOVola_ID_persist->r_Schw_arr,
+                                          TOVola_ID_persist->rho_energy_arr, TOVola_ID_persist->rho_baryon_arr, TOVola_ID_persist->P_arr,
+                                          TOVola_ID_persist->M_arr, TOVola_ID_persist->expnu_arr, TOVola_ID_persist->exp4phi_arr, r_iso_arr,
+                                          &hi[TOVOLA_GRID_RHO_ENERGY], &hi[TOVOLA_GRID_RHO_BARYON], &hi[TOVOLA_GRID_P], &M,
+                                          &hi[TOVOLA_GRID_EXPNU], &hi[TOVOLA_GRID_EXP4PHI]);
+        for (int f = 0; f < TOVOLA_NUM_GRID_FIELDS; f++) {
+          if (fabs(lo[f] - hi[f]) > tolerance * scale[f]) ok = 0;
+        }
+      }
+      if (ok) s_pick = s;
+    }
+    TOVola_ID_persist->stencil_arr[idx] = (unsigned char)s_pick;
+    stencil_sum += s_pick;
+  }
+  return (CCTK_REAL)stencil_sum / numpoints;
+}
+
 /* Interpolation Function using Lagrange Polynomial */
 static void TOVola_TOV_interpolate_1D(CCTK_REAL rr_iso,
                                       const int Interpolation_Stencil, const int Max_Interpolation_Stencil, const int numpoints_arr, const CCTK_REAL *restrict r_Schw_arr,
@@ -70,56 +241,9 @@ static void TOVola_TOV_interpolate_1D(CCTK_REAL rr_iso,
     // First find the central interpolation stencil index:
     int idx_mid = TOVola_bisection_idx_finder(rr_iso, numpoints_arr, r_iso_arr);
 
-    /* Use standard library functions instead of redefining macros */
-    int idxmin = MAX(0, idx_mid - Interpolation_Stencil / 2 - 1);
-
-    // -= Do not allow the interpolation stencil to cross the star's surface =-
-    // max index is when idxmin + (TOVola_Interpolation_stencil-1) = R_idx
-    //  -> idxmin at most can be R_idx - TOVola_Interpolation_stencil + 1
-    idxmin = MIN(idxmin, R_idx - Interpolation_Stencil + 1);
-
-    // Ensure that Interpolation_Stencil does not exceed the maximum
-    if (Interpolation_Stencil > Max_Interpolation_Stencil) {
-      CCTK_ERROR("Interpolation stencil size exceeds maximum allowed.");
-    }
-
-    // Now perform the Lagrange polynomial interpolation:
-
-    // First compute the interpolation coefficients:
-    CCTK_REAL r_iso_sample[Max_Interpolation_Stencil];
-    for (int i = idxmin; i < idxmin + Interpolation_Stencil; i++) {
-      r_iso_sample[i - idxmin] = r_iso_arr[i];
-    }
-    CCTK_REAL l_i_of_r[Max_Interpolation_Stencil];
-    for (int i = 0; i < Interpolation_Stencil; i++) {
-      CCTK_REAL numer = 1.0;
-      CCTK_REAL denom = 1.0;
-      for (int j = 0; j < Interpolation_Stencil; j++) {
-        if (j != i) {
-          numer *= (rr_iso - r_iso_sample[j]);
-          denom *= (r_iso_sample[i] - r_iso_sample[j]);
-        }
-      }
-      l_i_of_r[i] = numer / denom;
-    }
-
-    // Then perform the interpolation:
-    *rho_energy = 0.0;
-    *rho_baryon = 0.0;
-    *P = 0.0;
-    *M = 0.0;
-    *expnu = 0.0;
-    *exp4phi = 0.0;
-
-    for (int i = idxmin; i < idxmin + Interpolation_Stencil; i++) {
-      r_Schw += l_i_of_r[i - idxmin] * r_Schw_arr[i];
-      *rho_energy += l_i_of_r[i - idxmin] * rho_energy_arr[i];
-      *rho_baryon += l_i_of_r[i - idxmin] * rho_baryon_arr[i];
-      *P += l_i_of_r[i - idxmin] * P_arr[i];
-      *M += l_i_of_r[i - idxmin] * M_arr[i];
-      *expnu += l_i_of_r[i - idxmin] * expnu_arr[i];
-      *exp4phi += l_i_of_r[i - idxmin] * exp4phi_arr[i];
-    }
+    TOVola_TOV_interpolate_1D_stencil(rr_iso, idx_mid, Interpolation_Stencil, Max_Interpolation_Stencil, numpoints_arr, r_Schw_arr,
+                                      rho_energy_arr, rho_baryon_arr, P_arr, M_arr, expnu_arr, exp4phi_arr, r_iso_arr,
+                                      rho_energy, rho_baryon, P, M, expnu, exp4phi);
 
   } else {
     // If we are OUTSIDE the star, the solution is just Schwarzschild.
@@ -132,3 +256,123 @@ static void TOVola_TOV_interpolate_1D(CCTK_REAL rr_iso,
     *exp4phi = (r_Schw * r_Schw) / (rr_iso * rr_iso);
   }
 }
+
+/* Counting sort of sample radii in [0, r_max) into approximately increasing order.
+   One bin per sample, so the output is sorted up to within-bin order, which the hunt finder absorbs.
+   order[] receives a permutation of 0..n-1; bin_start[] is scratch of size n+1. */
+static void TOVola_bin_by_radius(const int n, const CCTK_REAL *restrict r, const CCTK_REAL r_max, int *restrict order, int *restrict bin_start) {
+  for (int b = 0; b <= n; b++) {
+    bin_start[b] = 0;
+  }
+  const CCTK_REAL bins_per_r = n / r_max;
+  for (int p = 0; p < n; p++) {
+    const int b = MIN(n - 1, (int)(r[p] * bins_per_r));
+    bin_start[b + 1]++;
+  }
+  for (int b = 0; b < n; b++) {
+    bin_start[b + 1] += bin_start[b];
+  }
+  for (int p = 0; p < n; p++) {
+    const int b = MIN(n - 1, (int)(r[p] * bins_per_r));
+    order[bin_start[b]++] = p;
+  }
+}
+
+/* Number of grid points handled together by the batched interpolator (a multiple of the AVX-512 double width) */
+#define TOVOLA_INTERP_BATCH 16
+
+/* Pack the normalized profile into interleaved knots for the batched interpolator */
+static int TOVola_pack_knots(TOVola_ID_persist_struct *restrict TOVola_ID_persist) {
+  const int numpoints = TOVola_ID_persist->numpoints_arr;
+  TOVola_ID_persist->knots = (TOVola_knot_struct *restrict)malloc(sizeof(TOVola_knot_struct) * numpoints);
+  if (!TOVola_ID_persist->knots) {
+    return -1;
+  }
+  for (int i = 0; i < numpoints; i++) {
+    TOVola_ID_persist->knots[i].r_iso = TOVola_ID_persist->r_iso_arr[i];
+    TOVola_ID_persist->knots[i].rho_energy = TOVola_ID_persist->rho_energy_arr[i];
+    TOVola_ID_persist->knots[i].rho_baryon = TOVola_ID_persist->rho_baryon_arr[i];
+    TOVola_ID_persist->knots[i].P = TOVola_ID_persist->P_arr[i];
+    TOVola_ID_persist->knots[i].expnu = TOVola_ID_persist->expnu_arr[i];
+    TOVola_ID_persist->knots[i].exp4phi = TOVola_ID_persist->exp4phi_arr[i];
+  }
+  return 0;
+}
+
+/* Batched Lagrange interpolation of up to TOVOLA_INTERP_BATCH points strictly inside the star.
+   The stencil search is scalar; the weights and the gathers from the interleaved knots run with
+   the batch as the innermost (SIMD) dimension. Results match TOVola_TOV_interpolate_1D point by point. */
+static void TOVola_TOV_interpolate_1D_batch(const int nb, const CCTK_REAL *restrict rr_iso,
+                                            const int Interpolation_Stencil, const int Max_Interpolation_Stencil, const int numpoints_arr,
+                                            const CCTK_REAL *restrict r_iso_arr, const TOVola_knot_struct *restrict knots,
+                                            CCTK_REAL *restrict rho_energy, CCTK_REAL *restrict rho_baryon, CCTK_REAL *restrict P,
+                                            CCTK_REAL *restrict expnu, CCTK_REAL *restrict exp4phi) {
+
+  const int R_idx = numpoints_arr - 1;
+
+  if (Interpolation_Stencil > Max_Interpolation_Stencil) {
+    CCTK_ERROR("Interpolation stencil size exceeds maximum allowed.");
+  }
+
+  // Stencil placement, identical to the scalar interpolator.
+  CCTK_REAL rr[TOVOLA_INTERP_BATCH];
+  int idxmin[TOVOLA_INTERP_BATCH];
+  for (int b = 0; b < nb; b++) {
+    rr[b] = fabs(rr_iso[b]);
+    const int idx_mid = TOVola_bisection_idx_finder(rr[b], numpoints_arr, r_iso_arr);
+    idxmin[b] = MIN(MAX(0, idx_mid - Interpolation_Stencil / 2 - 1), R_idx - Interpolation_Stencil + 1);
+  }
+
+  // Gather the stencil abscissae, then compute the Lagrange weights lane-wise.
+  CCTK_REAL r_iso_sample[Max_Interpolation_Stencil][TOVOLA_INTERP_BATCH];
+  for (int s = 0; s < Interpolation_Stencil; s++) {
+#pragma omp simd
+    for (int b = 0; b < nb; b++) {
+      r_iso_sample[s][b] = knots[idxmin[b] + s].r_iso;
+    }
+  }
+  CCTK_REAL l_i_of_r[Max_Interpolation_Stencil][TOVOLA_INTERP_BATCH];
+  for (int i = 0; i < Interpolation_Stencil; i++) {
+    CCTK_REAL numer[TOVOLA_INTERP_BATCH];
+    CCTK_REAL denom[TOVOLA_INTERP_BATCH];
+#pragma omp simd
+    for (int b = 0; b < nb; b++) {
+      numer[b] = 1.0;
+      denom[b] = 1.0;
+    }
+    for (int j = 0; j < Interpolation_Stencil; j++) {
+      if (j != i) {
+#pragma omp simd
+        for (int b = 0; b < nb; b++) {
+          numer[b] *= (rr[b] - r_iso_sample[j][b]);
+          denom[b] *= (r_iso_sample[i][b] - r_iso_sample[j][b]);
+        }
+      }
+    }
+#pragma omp simd
+    for (int b = 0; b < nb; b++) {
+      l_i_of_r[i][b] = numer[b] / denom[b];
+    }
+  }
+
+  // Accumulate all fields from one knot record per stencil point.
+#pragma omp simd
+  for (int b = 0; b < nb; b++) {
+    rho_energy[b] = 0.0;
+    rho_baryon[b] = 0.0;
+    P[b] = 0.0;
+    expnu[b] = 0.0;
+    exp4phi[b] = 0.0;
+  }
+  for (int s = 0; s < Interpolation_Stencil; s++) {
+#pragma omp simd
+    for (int b = 0; b < nb; b++) {
+      const TOVola_knot_struct *restrict knot = &knots[idxmin[b] + s];
+      rho_energy[b] += l_i_of_r[s][b] * knot->rho_energy;
+      rho_baryon[b] += l_i_of_r[s][b] * knot->rho_baryon;
+      P[b] += l_i_of_r[s][b] * knot->P;
+      expnu[b] += l_i_of_r[s][b] * knot->expnu;
+      exp4phi[b] += l_i_of_r[s][b] * knot->exp4phi;
+    }
+  }
+}
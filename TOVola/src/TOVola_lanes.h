@@ -0,0 +1,244 @@
+#pragma once
+
+//This header holds a lane-batched TOV integrator for sequences of polytropic stars. A single TOV system has only a few
+//equations, far too few for the vector units, so here TOVOLA_LANES stars are advanced in lockstep in structure-of-arrays form:
+//every stage of the embedded RKF45 step is one SIMD loop over the lanes. Each lane keeps its own radius and step size, and
+//lanes that reject a step simply keep their old state. A lane whose star reached the surface is refilled with the next star
+//of a queue shared by all threads, so the lanes stay busy until the queue runs dry.
+//
+//Only the surface quantities are needed, so the state is (P, m, M_b): the baryon mass is integrated as an extra component
+//instead of from stored samples, and no profile is kept. The cold polytropic EOS (Simple or Piecewise) is evaluated inline,
+//with the region selected per lane by comparing the pressure against the region boundaries.
+
+#include "GRHayLib.h"
+#include "TOVola_defines.h"
+#include <math.h>
+
+#include <cctk.h>
+
+#define TOVOLA_LANES 8
+#define TOVOLA_LANES_DIM 3
+#define TOVOLA_LANES_PRESSURE 0
+#define TOVOLA_LANES_MASS 1
+#define TOVOLA_LANES_BARYON_MASS 2
+// A step that would cross the surface is shortened until it is this small relative to r; the surface is then at r.
+#define TOVOLA_LANES_SURFACE_TOL 1.0e-12
+// Absolute error floor of the pressure relative to the central pressure. P falls off like a power of the distance to the
+// surface, so an absolute tolerance on P alone would let the radius drift by the square root of that tolerance (or worse).
+#define TOVOLA_LANES_PRESSURE_FLOOR 1.0e-10
+
+/* The cold piecewise polytrope, with the region boundaries converted to pressures */
+typedef struct {
+  int neos;
+  CCTK_REAL P_bound[ghl_max_neos]; // Lowest pressure of region i (unused for i=0)
+  CCTK_REAL rho_bound[ghl_max_neos];
+  CCTK_REAL K[ghl_max_neos];
+  CCTK_REAL Gamma[ghl_max_neos];
+  CCTK_REAL eps_const[ghl_max_neos];
+} TOVola_lanes_eos_struct;
+
+/* Integrator settings, from the parfile */
+typedef struct {
+  CCTK_REAL error_limit;
+  CCTK_REAL initial_step;
+  CCTK_REAL min_step;
+  CCTK_REAL max_step;
+  long max_steps;
+} TOVola_lanes_params_struct;
+
+/* The state of TOVOLA_LANES stars; lane l integrates star star[l], or nothing if star[l] < 0 */
+typedef struct {
+  CCTK_REAL r[TOVOLA_LANES];
+  CCTK_REAL h[TOVOLA_LANES];
+  CCTK_REAL y[TOVOLA_LANES_DIM][TOVOLA_LANES];
+  CCTK_REAL y_floor[TOVOLA_LANES_DIM][TOVOLA_LANES]; // Absolute part of the error scale of each component
+  int star[TOVOLA_LANES];
+  long steps[TOVOLA_LANES];
+} TOVola_lanes_struct;
+
+static void TOVola_lanes_set_eos(const ghl_eos_parameters *restrict eos, TOVola_lanes_eos_struct *restrict leos) {
+  leos->neos = eos->neos;
+  for (int i = 0; i < eos->neos; i++) {
+    leos->K[i] = eos->K_ppoly[i];
+    leos->Gamma[i] = eos->Gamma_ppoly[i];
+    leos->eps_const[i] = eos->eps_integ_const[i];
+    leos->rho_bound[i] = i > 0 ? eos->rho_ppoly[i - 1] : 0.0;
+    leos->P_bound[i] = i > 0 ? eos->K_ppoly[i] * pow(eos->rho_ppoly[i - 1], eos->Gamma_ppoly[i]) : 0.0;
+  }
+}
+
+/* RHS of (P, m, M_b) for all lanes; written as selects so that the loop vectorizes */
+static void TOVola_lanes_rhs(const TOVola_lanes_eos_struct *restrict leos, const CCTK_REAL *restrict r,
+                             CCTK_REAL y[TOVOLA_LANES_DIM][TOVOLA_LANES], CCTK_REAL dydr[TOVOLA_LANES_DIM][TOVOLA_LANES]) {
+#pragma omp simd
+  for (int l = 0; l < TOVOLA_LANES; l++) {
+    const CCTK_REAL P = y[TOVOLA_LANES_PRESSURE][l] > 0.0 ? y[TOVOLA_LANES_PRESSURE][l] : 0.0;
+    const CCTK_REAL M = y[TOVOLA_LANES_MASS][l];
+    CCTK_REAL K = leos->K[0], Gamma = leos->Gamma[0], eps_const = leos->eps_const[0];
+    for (int i = 1; i < leos->neos; i++) {
+      const int above = P >= leos->P_bound[i];
+      K = above ? leos->K[i] : K;
+      Gamma = above ? leos->Gamma[i] : Gamma;
+      eps_const = above ? leos->eps_const[i] : eps_const;
+    }
+    const CCTK_REAL rho_baryon = P > 0.0 ? pow(P / K, 1.0 / Gamma) : 0.0;
+    const CCTK_REAL rho_energy = rho_baryon * (1.0 + eps_const) + P / (Gamma - 1.0);
+
+    // At the center the equations are 0/0; the derivatives vanish there.
+    const int center = !(r[l] > 0.0);
+    const CCTK_REAL rr = center ? 1.0 : r[l];
+    const CCTK_REAL mass_term = 2.0 * M / rr;
+    const CCTK_REAL denominator = 1.0 - mass_term;
+    const CCTK_REAL dPdr = -((rho_energy + P) * (mass_term + 8.0 * M_PI * rr * rr * P)) / (2.0 * rr * denominator);
+    const CCTK_REAL dMdr = 4.0 * M_PI * rr * rr * rho_energy;
+    const CCTK_REAL dMbdr = 4.0 * M_PI * rr * rr * rho_baryon / sqrt(denominator);
+    dydr[TOVOLA_LANES_PRESSURE][l] = center ? 0.0 : dPdr;
+    dydr[TOVOLA_LANES_MASS][l] = center ? 0.0 : dMdr;
+    dydr[TOVOLA_LANES_BARYON_MASS][l] = center ? 0.0 : dMbdr;
+  }
+}
+
+/* Put star s of central density rho_c into lane l */
+static void TOVola_lanes_load(const TOVola_lanes_eos_struct *restrict leos, const TOVola_lanes_params_struct *restrict params,
+                              TOVola_lanes_struct *restrict lanes, const int l, const int s, const CCTK_REAL rho_c) {
+  int region = 0;
+  for (int i = 1; i < leos->neos; i++)
+    if (rho_c >= leos->rho_bound[i]) region = i;
+  lanes->star[l] = s;
+  lanes->r[l] = 0.0;
+  lanes->h[l] = params->initial_step;
+  lanes->steps[l] = 0;
+  lanes->y[TOVOLA_LANES_PRESSURE][l] = leos->K[region] * pow(rho_c, leos->Gamma[region]);
+  lanes->y[TOVOLA_LANES_MASS][l] = 0.0;
+  lanes->y[TOVOLA_LANES_BARYON_MASS][l] = 0.0;
+  lanes->y_floor[TOVOLA_LANES_PRESSURE][l] = TOVOLA_LANES_PRESSURE_FLOOR * lanes->y[TOVOLA_LANES_PRESSURE][l];
+  lanes->y_floor[TOVOLA_LANES_MASS][l] = 1.0;
+  lanes->y_floor[TOVOLA_LANES_BARYON_MASS][l] = 1.0;
+}
+
+/* Attempt one RKF45 step in every lane, updating the lanes in place. done[l] is set to 1 if the star in lane l reached its
+   surface, else to 0. */
+static void TOVola_lanes_step(const TOVola_lanes_eos_struct *restrict leos, const TOVola_lanes_params_struct *restrict params,
+                              TOVola_lanes_struct *restrict lanes, int *restrict done) {
+  // Fehlberg 4(5) tableau; the 5th-order solution is propagated, as in GSL's rkf45
+  static const CCTK_REAL c[6] = {0.0, 1.0 / 4.0, 3.0 / 8.0, 12.0 / 13.0, 1.0, 1.0 / 2.0};
+  static const CCTK_REAL a[6][5] = {{0},
+                                    {1.0 / 4.0},
+                                    {3.0 / 32.0, 9.0 / 32.0},
+                                    {1932.0 / 2197.0, -7200.0 / 2197.0, 7296.0 / 2197.0},
+                                    {439.0 / 216.0, -8.0, 3680.0 / 513.0, -845.0 / 4104.0},
+                                    {-8.0 / 27.0, 2.0, -3544.0 / 2565.0, 1859.0 / 4104.0, -11.0 / 40.0}};
+  static const CCTK_REAL b5[6] = {16.0 / 135.0, 0.0, 6656.0 / 12825.0, 28561.0 / 56430.0, -9.0 / 50.0, 2.0 / 55.0};
+  static const CCTK_REAL e45[6] = {1.0 / 360.0, 0.0, -128.0 / 4275.0, -2197.0 / 75240.0, 1.0 / 50.0, 2.0 / 55.0};
+
+  CCTK_REAL k[6][TOVOLA_LANES_DIM][TOVOLA_LANES];
+  CCTK_REAL ytmp[TOVOLA_LANES_DIM][TOVOLA_LANES];
+  CCTK_REAL rtmp[TOVOLA_LANES];
+
+  for (int s = 0; s < 6; s++) {
+    for (int d = 0; d < TOVOLA_LANES_DIM; d++) {
+#pragma omp simd
+      for (int l = 0; l < TOVOLA_LANES; l++) {
+        CCTK_REAL sum = 0.0;
+        for (int q = 0; q < s; q++) sum += a[s][q] * k[q][d][l];
+        ytmp[d][l] = lanes->y[d][l] + lanes->h[l] * sum;
+      }
+    }
+#pragma omp simd
+    for (int l = 0; l < TOVOLA_LANES; l++) rtmp[l] = lanes->r[l] + c[s] * lanes->h[l];
+    TOVola_lanes_rhs(leos, rtmp, ytmp, k[s]);
+  }
+
+  /* Per-lane error estimate and new state; lanes without a star are computed too and ignored */
+  CCTK_REAL ratio[TOVOLA_LANES];
+#pragma omp simd
+  for (int l = 0; l < TOVOLA_LANES; l++) ratio[l] = 0.0;
+  for (int d = 0; d < TOVOLA_LANES_DIM; d++) {
+#pragma omp simd
+    for (int l = 0; l < TOVOLA_LANES; l++) {
+      CCTK_REAL y5 = 0.0, err = 0.0;
+      for (int s = 0; s < 6; s++) {
+        y5 += b5[s] * k[s][d][l];
+        err += e45[s] * k[s][d][l];
+      }
+      y5 = lanes->y[d][l] + lanes->h[l] * y5;
+      err = fabs(lanes->h[l] * err) / (params->error_limit * (lanes->y_floor[d][l] + fabs(y5)));
+      ytmp[d][l] = y5;
+      ratio[l] = err > ratio[l] ? err : ratio[l];
+    }
+  }
+
+  /* Accept, reject, or approach the surface, lane by lane */
+  for (int l = 0; l < TOVOLA_LANES; l++) {
+    done[l] = 0;
+    if (lanes->star[l] < 0) continue;
+    lanes->steps[l]++;
+    const CCTK_REAL P = lanes->y[TOVOLA_LANES_PRESSURE][l];
+    const CCTK_REAL P_new = ytmp[TOVOLA_LANES_PRESSURE][l];
+    if (ratio[l] > 1.0) {
+      // Error too large: shrink as GSL's standard control does
+      lanes->h[l] *= fmax(0.2, 0.9 * pow(ratio[l], -1.0 / 5.0));
+    } else if (!(P_new > 0.0)) {
+      // The step crosses the surface: done once the step is negligible, else shorten it toward the linear estimate of P=0
+      if (lanes->h[l] <= fmax(TOVOLA_LANES_SURFACE_TOL * lanes->r[l], params->min_step)) {
+        done[l] = 1;
+      } else {
+        lanes->h[l] *= fmin(0.5, fmax(1.0e-3, 0.9 * P / (P - P_new)));
+      }
+    } else {
+      lanes->r[l] += lanes->h[l];
+      for (int d = 0; d < TOVOLA_LANES_DIM; d++) lanes->y[d][l] = ytmp[d][l];
+      lanes->h[l] *= fmin(5.0, ratio[l] > 0.0 ? 0.9 * pow(ratio[l], -1.0 / 6.0) : 5.0);
+    }
+    lanes->h[l] = fmin(fmax(lanes->h[l], params->min_step), params->max_step);
+    if (!done[l] && lanes->steps[l] >= params->max_steps)
+      CCTK_VERROR("TOVola lane integrator exceeded %ld steps for star %d of the sequence.", params->max_steps, lanes->star[l]);
+  }
+}
+
+/* Integrate stars from the queue rho_c[0..n-1] until it is empty. *next is the index of the next unclaimed star, shared by all
+   threads calling this concurrently; each thread brings its own lanes. Results go to stars[s]. */
+static void TOVola_lanes_solve(const TOVola_lanes_eos_struct *restrict leos, const TOVola_lanes_params_struct *restrict params,
+                               const int n, const CCTK_REAL *restrict rho_c, int *next, TOVola_sequence_star_struct *restrict stars) {
+  TOVola_lanes_struct lanes;
+  int done[TOVOLA_LANES];
+  int num_active = 0;
+
+  for (int l = 0; l < TOVOLA_LANES; l++) {
+    int s;
+#pragma omp atomic capture
+    s = (*next)++;
+    if (s < n) {
+      TOVola_lanes_load(leos, params, &lanes, l, s, rho_c[s]);
+      num_active++;
+    } else {
+      TOVola_lanes_load(leos, params, &lanes, l, -1, rho_c[0]);
+    }
+  }
+
+  while (num_active > 0) {
+    TOVola_lanes_step(leos, params, &lanes, done);
+    for (int l = 0; l < TOVOLA_LANES; l++) {
+      if (!done[l]) continue;
+      const int s = lanes.star[l];
+      const CCTK_REAL R = lanes.r[l];
+      const CCTK_REAL M = lanes.y[TOVOLA_LANES_MASS][l];
+      stars[s].central_baryon_density = rho_c[s];
+      stars[s].mass = M;
+      stars[s].baryon_mass = lanes.y[TOVOLA_LANES_BARYON_MASS][l];
+      stars[s].radius_Schw = R;
+      stars[s].radius_iso = 0.5 * (sqrt(R * (R - 2.0 * M)) + R - M);
+      stars[s].num_rhs_evaluations = 6 * lanes.steps[l];
+
+      int s_next;
+#pragma omp atomic capture
+      s_next = (*next)++;
+      if (s_next < n) {
+        TOVola_lanes_load(leos, params, &lanes, l, s_next, rho_c[s_next]);
+      } else {
+        lanes.star[l] = -1;
+        num_active--;
+      }
+    }
+  }
+}
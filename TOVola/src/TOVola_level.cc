@@ -0,0 +1,111 @@
+//Level-mode entry point for Carpet runs. Carpet calls a local-mode routine once per component, so TOVola would solve the TOV
+//equations again and start a new OpenMP region for every (often tiny) box. Here the local components of the whole refinement level
+//are collected with Carpet's component loops and handed to TOVola_Solve_and_Interp_patches, which solves once and fills them all as tasks.
+
+#include <vector>
+
+#include <cctk.h>
+#include <cctk_Arguments.h>
+#include <cctk_Parameters.h>
+
+#ifdef HAVE_CAPABILITY_Carpet
+#include <carpet.hh>
+#endif
+
+#include "TOVola_defines.h"
+
+extern "C" void TOVola_Solve_and_Interp_Level(CCTK_ARGUMENTS){
+
+  DECLARE_CCTK_PARAMETERS;
+
+#ifdef HAVE_CAPABILITY_Carpet
+  std::vector<TOVola_patch_struct> patches;
+  BEGIN_LOCAL_MAP_LOOP(cctkGH, CCTK_GF) {
+    BEGIN_LOCAL_COMPONENT_LOOP(cctkGH, CCTK_GF) {
+      DECLARE_CCTK_ARGUMENTS;
+      const int npoints = cctk_ash[0]*cctk_ash[1]*cctk_ash[2]; //Offset between the components of vel
+
+      TOVola_patch_struct patch;
+      for(int d=0; d<3; d++){
+        patch.lsh[d] = cctk_lsh[d];
+        patch.ash[d] = cctk_ash[d];
+      }
+      patch.x = x;
+      patch.y = y;
+      patch.z = z;
+
+      TOVola_gf_struct &gf = patch.gf;
+      gf.rho = rho;
+      gf.press = press;
+      gf.eps = eps;
+      gf.alp = alp;
+      gf.gxx = gxx;
+      gf.gyy = gyy;
+      gf.gzz = gzz;
+      gf.gxy = gxy;
+      gf.gxz = gxz;
+      gf.gyz = gyz;
+      gf.betax = betax;
+      gf.betay = betay;
+      gf.betaz = betaz;
+      gf.kxx = kxx;
+      gf.kyy = kyy;
+      gf.kzz = kzz;
+      gf.kxy = kxy;
+      gf.kxz = kxz;
+      gf.kyz = kyz;
+      gf.vel_x = &vel[0*npoints];
+      gf.vel_y = &vel[1*npoints];
+      gf.vel_z = &vel[2*npoints];
+      gf.w_lorentz = w_lorentz;
+      gf.Y_e = CCTK_EQUALS(initial_Y_e,"TOVola") ? Y_e : NULL;
+      gf.temperature = CCTK_EQUALS(initial_temperature,"TOVola") ? temperature : NULL;
+      gf.entropy = CCTK_EQUALS(initial_entropy,"TOVola") ? entropy : NULL;
+      gf.beq = NULL;
+
+      //Past timelevels, as in TOVola_Solve_and_Interp.
+      CCTK_REAL *const past_rho[TOVOLA_MAX_PAST_LEVELS] = {rho_p, rho_p_p};
+      CCTK_REAL *const past_eps[TOVOLA_MAX_PAST_LEVELS] = {eps_p, eps_p_p};
+      CCTK_REAL *const past_gxx[TOVOLA_MAX_PAST_LEVELS] = {gxx_p, gxx_p_p};
+      CCTK_REAL *const past_gyy[TOVOLA_MAX_PAST_LEVELS] = {gyy_p, gyy_p_p};
+      CCTK_REAL *const past_gzz[TOVOLA_MAX_PAST_LEVELS] = {gzz_p, gzz_p_p};
+      CCTK_REAL *const past_gxy[TOVOLA_MAX_PAST_LEVELS] = {gxy_p, gxy_p_p};
+      CCTK_REAL *const past_gxz[TOVOLA_MAX_PAST_LEVELS] = {gxz_p, gxz_p_p};
+      CCTK_REAL *const past_gyz[TOVOLA_MAX_PAST_LEVELS] = {gyz_p, gyz_p_p};
+      CCTK_REAL *const past_vel[TOVOLA_MAX_PAST_LEVELS] = {vel_p, vel_p_p};
+      CCTK_REAL *const past_w_lorentz[TOVOLA_MAX_PAST_LEVELS] = {w_lorentz_p, w_lorentz_p_p};
+      CCTK_REAL *const past_Y_e[TOVOLA_MAX_PAST_LEVELS] = {Y_e_p, Y_e_p_p};
+      CCTK_REAL *const past_temperature[TOVOLA_MAX_PAST_LEVELS] = {temperature_p, temperature_p_p};
+      CCTK_REAL *const past_entropy[TOVOLA_MAX_PAST_LEVELS] = {entropy_p, entropy_p_p};
+      TOVola_past_gf_struct past[TOVOLA_MAX_PAST_LEVELS];
+      for(int l=0; l<TOVOLA_MAX_PAST_LEVELS; l++){
+        past[l].rho = past_rho[l];
+        past[l].eps = past_eps[l];
+        past[l].gxx = past_gxx[l];
+        past[l].gyy = past_gyy[l];
+        past[l].gzz = past_gzz[l];
+        past[l].gxy = past_gxy[l];
+        past[l].gxz = past_gxz[l];
+        past[l].gyz = past_gyz[l];
+        past[l].vel_x = past_vel[l] ? &past_vel[l][0*npoints] : NULL;
+        past[l].vel_y = past_vel[l] ? &past_vel[l][1*npoints] : NULL;
+        past[l].vel_z = past_vel[l] ? &past_vel[l][2*npoints] : NULL;
+        past[l].w_lorentz = past_w_lorentz[l];
+        past[l].Y_e = gf.Y_e ? past_Y_e[l] : NULL;
+        past[l].temperature = gf.temperature ? past_temperature[l] : NULL;
+        past[l].entropy = gf.entropy ? past_entropy[l] : NULL;
+      }
+      TOVola_set_past_levels(&gf, past);
+
+      patches.push_back(patch);
+    } END_LOCAL_COMPONENT_LOOP;
+  } END_LOCAL_MAP_LOOP;
+
+  //Nothing to do if this process owns no part of the level.
+  if (patches.empty()) return;
+  CCTK_VINFO("Filling %d local components of refinement level %d together.", (int)patches.size(), Carpet::reflevel);
+  TOVola_Solve_and_Interp_patches((int)patches.size(), patches.data());
+#else
+  CCTK_ERROR("TOVola_fill_all_components requires Carpet. Set TOVola_fill_all_components = no on unigrid drivers.");
+#endif
+}
@@ -0,0 +1,402 @@
+//Star library. With TOVola_build_star_library, TOVola_star_library_num_stars stars with central densities spaced logarithmically
+//between TOVola_star_library_min_central_baryon_density and TOVola_star_library_max_central_baryon_density are integrated and
+//normalized once, resampled onto a common mass coordinate, and written to the indexed binary file TOVola_star_library.
+//A later run with TOVola_star_library set takes each profile from that file instead of integrating: the four members nearest
+//in log(rho_c) are read and interpolated sample by sample, so that the profile of any central density in the range costs a
+//few reads and no solve.
+//
+//The mass coordinate is s = [(m/M)^{1/3} + r_Schw/R_Schw]/2, which runs from 0 at the center to 1 at the surface for every star.
+//(m/M)^{1/3} spreads the samples over the core, where the mass is, and r/R keeps the low-density envelope resolved, where m is
+//already close to M. Along a fixed s, every field varies smoothly with rho_c. The densities and the pressure grow like powers of
+//rho_c, which a cubic in log(rho_c) follows poorly; they are stored relative to their central values, and those central values
+//are interpolated in log.
+//
+//File layout (native byte order): TOVola_library_header_struct; the index, num_members central densities followed by
+//num_members file offsets (long) of the member records; then one record per member, with the TOVOLA_LIBRARY_NUM_SCALARS
+//scalars followed by the TOVOLA_LIBRARY_NUM_FIELDS fields of num_samples samples each.
+
+#include "GRHayLib.h"
+#include "TOVola_defines.h"
+#include "TOVola_solve.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <cctk.h>
+#include <cctk_Arguments.h>
+#include <cctk_Parameters.h>
+
+#define TOVOLA_LIBRARY_MAGIC "TOVolaL2"
+
+/* Samples of the beta-equilibrium P(rho) that fingerprint a tabulated EOS */
+#define TOVOLA_LIBRARY_TABLE_SAMPLES 8
+
+/* Fields of a member, in file order */
+#define TOVOLA_LIBRARY_NUM_FIELDS 8
+#define TOVOLA_LIBRARY_R_SCHW 0
+#define TOVOLA_LIBRARY_R_ISO 1
+#define TOVOLA_LIBRARY_RHO_ENERGY 2
+#define TOVOLA_LIBRARY_RHO_BARYON 3
+#define TOVOLA_LIBRARY_P 4
+#define TOVOLA_LIBRARY_M 5
+#define TOVOLA_LIBRARY_EXPNU 6
+#define TOVOLA_LIBRARY_EXP4PHI 7
+
+/* Scalars of a member, in file order: the surface quantities, and the central values of the fields stored relative to them */
+#define TOVOLA_LIBRARY_NUM_SCALARS 6
+#define TOVOLA_LIBRARY_BARYON_MASS 0
+#define TOVOLA_LIBRARY_MOMENT_OF_INERTIA 1
+#define TOVOLA_LIBRARY_LOVE_K2 2
+#define TOVOLA_LIBRARY_SCALED(f) ((f) >= TOVOLA_LIBRARY_RHO_ENERGY && (f) <= TOVOLA_LIBRARY_P)
+#define TOVOLA_LIBRARY_CENTRAL(f) (3 + (f) - TOVOLA_LIBRARY_RHO_ENERGY)
+
+typedef struct {
+  char magic[8];
+  int num_members;
+  int num_samples;
+  int num_fields;
+  int num_scalars;
+  int observables;     // Whether the moment of inertia and k2 were integrated
+  CCTK_REAL error_estimate; // Largest leave-one-out interpolation error among the members, relative to the field maxima
+  // EOS the library was built with
+  int eos_type;
+  int neos;
+  CCTK_REAL K_ppoly0;
+  CCTK_REAL Gamma_ppoly[ghl_max_neos];
+  CCTK_REAL rho_ppoly[ghl_max_neos];
+  // Tabulated EOSs: the table file name, and the beta-equilibrium slice at temperature T
+  CCTK_REAL T;
+  char table_name[256];
+  int N_rho;
+  CCTK_REAL table_logrho[TOVOLA_LIBRARY_TABLE_SAMPLES];
+  CCTK_REAL table_logP[TOVOLA_LIBRARY_TABLE_SAMPLES];
+} TOVola_library_header_struct;
+
+//Header fields that identify the EOS of this run. A table is identified by its file name (without the directory, so that
+//libraries can be moved between machines) and by samples of its beta-equilibrium slice.
+static void TOVola_library_eos_signature(TOVola_library_header_struct *restrict header, const int eos_type){
+  DECLARE_CCTK_PARAMETERS;
+  header->eos_type = eos_type;
+  if (eos_type == 2) {
+    header->T = TOVola_Tin;
+    int type;
+    const void *value = CCTK_ParameterGet("EOS_tablepath", "GRHayLib", &type);
+    if (value && type == PARAMETER_STRING) {
+      const char *path = *(const char *const *)value;
+      const char *name = strrchr(path, '/');
+      strncpy(header->table_name, name ? name + 1 : path, sizeof(header->table_name) - 1);
+    }
+    header->N_rho = ghl_eos->N_rho;
+    for(int j=0; j<TOVOLA_LIBRARY_TABLE_SAMPLES; j++){
+      const int i = (int)((long)j * (ghl_eos->N_rho - 1) / (TOVOLA_LIBRARY_TABLE_SAMPLES - 1));
+      header->table_logrho[j] = ghl_eos->table_logrho[i];
+      header->table_logP[j] = ghl_eos->lp_of_lr[i];
+    }
+    return;
+  }
+  header->neos = ghl_eos->neos;
+  header->K_ppoly0 = ghl_eos->K_ppoly[0];
+  for(int j=0; j<ghl_eos->neos; j++) header->Gamma_ppoly[j] = ghl_eos->Gamma_ppoly[j];
+  for(int j=0; j<ghl_eos->neos-1; j++) header->rho_ppoly[j] = ghl_eos->rho_ppoly[j];
+}
+
+//Cubic Lagrange weights of the point x on the four nodes xs
+static void TOVola_library_weights(const CCTK_REAL xs[4], const CCTK_REAL x, CCTK_REAL w[4]){
+  for(int a=0; a<4; a++){
+    w[a] = 1.0;
+    for(int b=0; b<4; b++)
+      if (b != a) w[a] *= (x - xs[b]) / (xs[a] - xs[b]);
+  }
+}
+
+//Index of the first of the four members around x = log(rho_c), clamped to the ends of the library
+static int TOVola_library_stencil(const int num_members, const CCTK_REAL *restrict log_rho_c, const CCTK_REAL x){
+  int i = 0;
+  while (i < num_members - 2 && log_rho_c[i+1] <= x) i++;
+  return MIN(MAX(i - 1, 0), num_members - 4);
+}
+
+/* Resample the normalized profile of n samples onto num_samples uniform samples of the mass coordinate, by 4-point Lagrange
+   interpolation in s. raw[f] are the n samples of field f, out[f] the num_samples resampled ones. The first and last samples
+   are copied, so that the surface is exact. The scaled fields are divided by their central values, which go to central[]. */
+static void TOVola_library_resample(const int n, CCTK_REAL *raw[TOVOLA_LIBRARY_NUM_FIELDS], const int num_samples,
+                                    CCTK_REAL *restrict out, CCTK_REAL *restrict central, CCTK_REAL *restrict s){
+  const CCTK_REAL R = raw[TOVOLA_LIBRARY_R_SCHW][n-1];
+  const CCTK_REAL M = raw[TOVOLA_LIBRARY_M][n-1];
+  for(int i=0; i<n; i++)
+    s[i] = 0.5 * (cbrt(raw[TOVOLA_LIBRARY_M][i] / M) + raw[TOVOLA_LIBRARY_R_SCHW][i] / R);
+
+  int j = 0;
+  for(int k=0; k<num_samples; k++){
+    CCTK_REAL w[4];
+    int i0 = 0;
+    if (k > 0 && k < num_samples - 1) {
+      const CCTK_REAL sk = (CCTK_REAL)k / (num_samples - 1);
+      while (j < n - 2 && s[j+1] <= sk) j++; // s grows monotonically, so the hunt only moves forward
+      i0 = MIN(MAX(j - 1, 0), n - 4);
+      TOVola_library_weights(&s[i0], MAX(sk, s[0]), w);
+    }
+    for(int f=0; f<TOVOLA_LIBRARY_NUM_FIELDS; f++){
+      CCTK_REAL *restrict outf = &out[f*num_samples];
+      if (k == 0) outf[k] = raw[f][0];
+      else if (k == num_samples - 1) outf[k] = raw[f][n-1];
+      else outf[k] = w[0]*raw[f][i0] + w[1]*raw[f][i0+1] + w[2]*raw[f][i0+2] + w[3]*raw[f][i0+3];
+    }
+  }
+  for(int f=0; f<TOVOLA_LIBRARY_NUM_FIELDS; f++){
+    if (!TOVOLA_LIBRARY_SCALED(f)) continue;
+    CCTK_REAL *restrict outf = &out[f*num_samples];
+    central[TOVOLA_LIBRARY_CENTRAL(f)] = outf[0];
+    for(int k=0; k<num_samples; k++) outf[k] /= central[TOVOLA_LIBRARY_CENTRAL(f)];
+  }
+}
+
+//Blend of the scalar c of four members with weights w: in log for the central values, linear otherwise
+static CCTK_REAL TOVola_library_blend_scalar(const CCTK_REAL w[4], const CCTK_REAL *const scalars[4], const int c){
+  CCTK_REAL sum = 0.0;
+  if (c < TOVOLA_LIBRARY_CENTRAL(TOVOLA_LIBRARY_RHO_ENERGY)) {
+    for(int a=0; a<4; a++) sum += w[a] * scalars[a][c];
+    return sum;
+  }
+  for(int a=0; a<4; a++) sum += w[a] * log(scalars[a][c]);
+  return exp(sum);
+}
+
+//Integrate, normalize and resample the library member of central density rho_c into record (scalars, then fields)
+static void TOVola_library_member(TOVola_data_struct *TOVdata, const CCTK_REAL rho_c, const int num_samples, CCTK_REAL *restrict record){
+  DECLARE_CCTK_PARAMETERS;
+  TOVdata->central_baryon_density = rho_c;
+  TOVola_integrate(TOVdata, TOVola_ODE_method, TOVola_size);
+
+  const int n = TOVdata->numpoints_actually_saved;
+  if (n < 4) CCTK_VERROR("The TOVola star library member of rho_c = %.6e has only %d samples.", rho_c, n);
+  CCTK_REAL *restrict scratch = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * n * (TOVOLA_LIBRARY_NUM_FIELDS + 1));
+  if (!scratch) CCTK_ERROR("Memory allocation failed for the TOVola star library.");
+  CCTK_REAL *raw[TOVOLA_LIBRARY_NUM_FIELDS];
+  for(int f=0; f<TOVOLA_LIBRARY_NUM_FIELDS; f++) raw[f] = &scratch[f*n];
+  TOVola_Normalize_and_set_data_integrated(TOVdata, raw[TOVOLA_LIBRARY_R_SCHW], raw[TOVOLA_LIBRARY_RHO_ENERGY], raw[TOVOLA_LIBRARY_RHO_BARYON],
+                                           raw[TOVOLA_LIBRARY_P], raw[TOVOLA_LIBRARY_M], raw[TOVOLA_LIBRARY_EXPNU], raw[TOVOLA_LIBRARY_EXP4PHI],
+                                           raw[TOVOLA_LIBRARY_R_ISO]);
+
+  record[TOVOLA_LIBRARY_BARYON_MASS] = TOVdata->observables ? TOVdata->baryon_mass
+                                                             : TOVola_baryon_mass(n, raw[TOVOLA_LIBRARY_R_SCHW], raw[TOVOLA_LIBRARY_RHO_BARYON], raw[TOVOLA_LIBRARY_M]);
+  record[TOVOLA_LIBRARY_MOMENT_OF_INERTIA] = TOVdata->moment_of_inertia;
+  record[TOVOLA_LIBRARY_LOVE_K2] = TOVdata->love_k2;
+  TOVola_library_resample(n, raw, num_samples, &record[TOVOLA_LIBRARY_NUM_SCALARS], record, &scratch[TOVOLA_LIBRARY_NUM_FIELDS*n]);
+  free(scratch);
+}
+
+/* Largest error of predicting an interior member from its four nearest neighbours, relative to the maximum of each field.
+   The neighbours are twice as far apart as in the library itself, so this bounds the error of interpolating between members
+   from above (by about 2^4 for smooth profiles). It also contains the scatter of the independently integrated members, mostly
+   in the surface radius, so it does not fall below the accuracy of the integration itself. */
+static CCTK_REAL TOVola_library_error_estimate(const int num_members, const int num_samples, const CCTK_REAL *restrict log_rho_c,
+                                               const CCTK_REAL *restrict records){
+  const int record_size = TOVOLA_LIBRARY_NUM_SCALARS + TOVOLA_LIBRARY_NUM_FIELDS * num_samples;
+  CCTK_REAL error = 0.0;
+  for(int j=1; j<num_members-1; j++){
+    const int lo = MIN(MAX(j - 2, 0), num_members - 5);
+    int nodes[4], a = 0;
+    for(int i=lo; i<lo+5; i++) if (i != j) nodes[a++] = i;
+    const CCTK_REAL xs[4] = {log_rho_c[nodes[0]], log_rho_c[nodes[1]], log_rho_c[nodes[2]], log_rho_c[nodes[3]]};
+    const CCTK_REAL *const scalars[4] = {&records[nodes[0]*record_size], &records[nodes[1]*record_size],
+                                          &records[nodes[2]*record_size], &records[nodes[3]*record_size]};
+    CCTK_REAL w[4];
+    TOVola_library_weights(xs, log_rho_c[j], w);
+    for(int f=0; f<TOVOLA_LIBRARY_NUM_FIELDS; f++){
+      const int offset = TOVOLA_LIBRARY_NUM_SCALARS + f*num_samples;
+      const CCTK_REAL *restrict actual = &records[j*record_size + offset];
+      const int scaled = TOVOLA_LIBRARY_SCALED(f);
+      const CCTK_REAL predicted_central = scaled ? TOVola_library_blend_scalar(w, scalars, TOVOLA_LIBRARY_CENTRAL(f)) : 1.0;
+      const CCTK_REAL actual_central = scaled ? records[j*record_size + TOVOLA_LIBRARY_CENTRAL(f)] : 1.0;
+      CCTK_REAL max_abs = 0.0, max_err = 0.0;
+      for(int k=0; k<num_samples; k++){
+        CCTK_REAL predicted = 0.0;
+        for(int b=0; b<4; b++) predicted += w[b] * records[nodes[b]*record_size + offset + k];
+        max_abs = MAX(max_abs, fabs(actual_central * actual[k]));
+        max_err = MAX(max_err, fabs(predicted_central * predicted - actual_central * actual[k]));
+      }
+      if (max_abs > 0) error = MAX(error, max_err / max_abs);
+    }
+  }
+  return error;
+}
+
+//Build the star library and write it to TOVola_star_library
+void TOVola_Build_Library(CCTK_ARGUMENTS){
+
+  DECLARE_CCTK_ARGUMENTS;
+  DECLARE_CCTK_PARAMETERS;
+
+  if (TOVola_star_library[0] == '\0') CCTK_ERROR("TOVola_build_star_library requires the file name TOVola_star_library.");
+  const int n = TOVola_star_library_num_stars;
+  const int num_samples = TOVola_star_library_num_samples;
+  const CCTK_REAL log_min = log(TOVola_star_library_min_central_baryon_density);
+  const CCTK_REAL log_max = log(TOVola_star_library_max_central_baryon_density);
+  if (!(log_max > log_min))
+    CCTK_ERROR("TOVola_star_library_max_central_baryon_density must be larger than TOVola_star_library_min_central_baryon_density.");
+  const int eos_type = TOVola_init_eos();
+
+  //The library does not depend on the grid; one process builds it, and the others wait for the file.
+  if (CCTK_MyProc(NULL) == 0) {
+    CCTK_VINFO("Building a TOVola star library of %d stars in %.6e <= rho_c <= %.6e...", n,
+               TOVola_star_library_min_central_baryon_density, TOVola_star_library_max_central_baryon_density);
+    const size_t record_size = TOVOLA_LIBRARY_NUM_SCALARS + (size_t)TOVOLA_LIBRARY_NUM_FIELDS * num_samples;
+    CCTK_REAL *restrict log_rho_c = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * n);
+    CCTK_REAL *restrict rho_c = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * n);
+    long *restrict offsets = (long *restrict)malloc(sizeof(long) * n);
+    CCTK_REAL *restrict records = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * record_size * n);
+    if (!log_rho_c || !rho_c || !offsets || !records) CCTK_ERROR("Memory allocation failed for the TOVola star library.");
+    for(int i=0; i<n; i++){
+      log_rho_c[i] = log_min + (log_max - log_min)*i/(n - 1);
+      rho_c[i] = exp(log_rho_c[i]);
+    }
+
+    //Denser stars need more steps, so hand out one star at a time. Each thread reuses one solver context for all of its stars.
+#pragma omp parallel
+    {
+      TOVola_data_struct TOVdata;
+      TOVola_set_solver_parameters(&TOVdata, eos_type, rho_c[0]);
+      TOVdata.store_derivatives = 0;
+#pragma omp for schedule(dynamic,1)
+      for(int i=0; i<n; i++) TOVola_library_member(&TOVdata, rho_c[i], num_samples, &records[i*record_size]);
+      free_tovola_data(&TOVdata);
+    }
+
+    TOVola_library_header_struct header;
+    memset(&header, 0, sizeof(header)); // Padding too, so that the file is reproducible
+    memcpy(header.magic, TOVOLA_LIBRARY_MAGIC, sizeof(header.magic));
+    header.num_members = n;
+    header.num_samples = num_samples;
+    header.num_fields = TOVOLA_LIBRARY_NUM_FIELDS;
+    header.num_scalars = TOVOLA_LIBRARY_NUM_SCALARS;
+    header.observables = TOVola_observables;
+    header.error_estimate = TOVola_library_error_estimate(n, num_samples, log_rho_c, records);
+    TOVola_library_eos_signature(&header, eos_type);
+    for(int i=0; i<n; i++)
+      offsets[i] = (long)(sizeof(header) + (sizeof(CCTK_REAL) + sizeof(long)) * n + sizeof(CCTK_REAL) * record_size * i);
+
+    FILE *file = fopen(TOVola_star_library, "wb");
+    if (!file) CCTK_VERROR("Could not open the TOVola star library '%s' for writing.", TOVola_star_library);
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && fwrite(rho_c, sizeof(CCTK_REAL), n, file) == (size_t)n;
+    ok = ok && fwrite(offsets, sizeof(long), n, file) == (size_t)n;
+    ok = ok && fwrite(records, sizeof(CCTK_REAL), record_size * n, file) == record_size * n;
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) CCTK_VERROR("Could not write the TOVola star library '%s'.", TOVola_star_library);
+    CCTK_VINFO("Wrote the TOVola star library '%s': %d stars of %d samples, estimated interpolation error %.3e.",
+               TOVola_star_library, n, num_samples, header.error_estimate);
+    if (header.error_estimate > TOVola_star_library_tolerance)
+      CCTK_VWARN(CCTK_WARN_ALERT, "The estimated interpolation error of the TOVola star library, %.3e, is above TOVola_star_library_tolerance = %.3e. "
+                 "Add stars or narrow the central-density range.", header.error_estimate, TOVola_star_library_tolerance);
+    free(log_rho_c);
+    free(rho_c);
+    free(offsets);
+    free(records);
+  }
+  CCTK_Barrier(cctkGH);
+}
+
+//Fill TOVola_ID_persist with the profile of central density central_baryon_density, interpolated from the star library
+//TOVola_star_library. The result is a normalized profile with the negative-r buffer, ready for TOVola_prepare_profile.
+void TOVola_library_profile(TOVola_ID_persist_struct *restrict TOVola_ID_persist, const CCTK_REAL central_baryon_density){
+
+  DECLARE_CCTK_PARAMETERS;
+
+  FILE *file = fopen(TOVola_star_library, "rb");
+  if (!file) CCTK_VERROR("Could not open the TOVola star library '%s'.", TOVola_star_library);
+  TOVola_library_header_struct header;
+  if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, TOVOLA_LIBRARY_MAGIC, sizeof(header.magic)) != 0
+      || header.num_fields != TOVOLA_LIBRARY_NUM_FIELDS || header.num_scalars != TOVOLA_LIBRARY_NUM_SCALARS || header.num_members < 5)
+    CCTK_VERROR("'%s' is not a TOVola star library.", TOVola_star_library);
+
+  TOVola_library_header_struct expected;
+  memset(&expected, 0, sizeof(expected));
+  TOVola_library_eos_signature(&expected, TOVola_init_eos());
+  if (header.eos_type != expected.eos_type || header.neos != expected.neos || header.K_ppoly0 != expected.K_ppoly0 || header.T != expected.T
+      || memcmp(header.Gamma_ppoly, expected.Gamma_ppoly, sizeof(header.Gamma_ppoly)) != 0
+      || memcmp(header.rho_ppoly, expected.rho_ppoly, sizeof(header.rho_ppoly)) != 0
+      || strcmp(header.table_name, expected.table_name) != 0 || header.N_rho != expected.N_rho
+      || memcmp(header.table_logrho, expected.table_logrho, sizeof(header.table_logrho)) != 0
+      || memcmp(header.table_logP, expected.table_logP, sizeof(header.table_logP)) != 0)
+    CCTK_VERROR("The TOVola star library '%s' was built for another EOS.", TOVola_star_library);
+  if (header.error_estimate > TOVola_star_library_tolerance)
+    CCTK_VERROR("The estimated interpolation error of the TOVola star library '%s', %.3e, is above TOVola_star_library_tolerance = %.3e.",
+                TOVola_star_library, header.error_estimate, TOVola_star_library_tolerance);
+  if (TOVola_observables && !header.observables)
+    CCTK_VERROR("TOVola_observables needs a TOVola star library built with TOVola_observables = yes; '%s' was not.", TOVola_star_library);
+
+  const int n = header.num_members;
+  const int num_samples = header.num_samples;
+  CCTK_REAL *restrict rho_c = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * n);
+  long *restrict offsets = (long *restrict)malloc(sizeof(long) * n);
+  if (!rho_c || !offsets) CCTK_ERROR("Memory allocation failed for the TOVola star library index.");
+  if (fread(rho_c, sizeof(CCTK_REAL), n, file) != (size_t)n || fread(offsets, sizeof(long), n, file) != (size_t)n)
+    CCTK_VERROR("Could not read the index of the TOVola star library '%s'.", TOVola_star_library);
+  // A relative slack of 1e-12 lets the end points through, although exp(log(rho_c)) rounds.
+  if (central_baryon_density < rho_c[0] * (1.0 - 1.0e-12) || central_baryon_density > rho_c[n-1] * (1.0 + 1.0e-12))
+    CCTK_VERROR("rho_c = %.6e is outside the TOVola star library '%s', which covers %.6e <= rho_c <= %.6e.", central_baryon_density,
+                TOVola_star_library, rho_c[0], rho_c[n-1]);
+
+  for(int i=0; i<n; i++) rho_c[i] = log(rho_c[i]);
+  const int i0 = TOVola_library_stencil(n, rho_c, log(central_baryon_density));
+  CCTK_REAL w[4];
+  TOVola_library_weights(&rho_c[i0], log(central_baryon_density), w);
+
+  /* Read the four members and blend them sample by sample */
+  const int numpoints = num_samples + NEGATIVE_R_INTERP_BUFFER;
+  if (TOVola_alloc_persist_profile(TOVola_ID_persist, numpoints) != 0)
+    CCTK_ERROR("Memory allocation failed for TOVola_ID_persist_struct arrays.\n");
+  CCTK_REAL *fields[TOVOLA_LIBRARY_NUM_FIELDS];
+  fields[TOVOLA_LIBRARY_R_SCHW] = TOVola_ID_persist->r_Schw_arr;
+  fields[TOVOLA_LIBRARY_R_ISO] = TOVola_ID_persist->r_iso_arr;
+  fields[TOVOLA_LIBRARY_RHO_ENERGY] = TOVola_ID_persist->rho_energy_arr;
+  fields[TOVOLA_LIBRARY_RHO_BARYON] = TOVola_ID_persist->rho_baryon_arr;
+  fields[TOVOLA_LIBRARY_P] = TOVola_ID_persist->P_arr;
+  fields[TOVOLA_LIBRARY_M] = TOVola_ID_persist->M_arr;
+  fields[TOVOLA_LIBRARY_EXPNU] = TOVola_ID_persist->expnu_arr;
+  fields[TOVOLA_LIBRARY_EXP4PHI] = TOVola_ID_persist->exp4phi_arr;
+  for(int f=0; f<TOVOLA_LIBRARY_NUM_FIELDS; f++)
+    for(int k=0; k<num_samples; k++) fields[f][k] = 0.0;
+  CCTK_REAL member_scalars[4][TOVOLA_LIBRARY_NUM_SCALARS];
+
+  CCTK_REAL *restrict member = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * num_samples);
+  if (!member) CCTK_ERROR("Memory allocation failed for the TOVola star library.");
+  for(int a=0; a<4; a++){
+    if (fseek(file, offsets[i0+a], SEEK_SET) != 0
+        || fread(member_scalars[a], sizeof(CCTK_REAL), TOVOLA_LIBRARY_NUM_SCALARS, file) != TOVOLA_LIBRARY_NUM_SCALARS)
+      CCTK_VERROR("Could not read member %d of the TOVola star library '%s'.", i0+a, TOVola_star_library);
+    for(int f=0; f<TOVOLA_LIBRARY_NUM_FIELDS; f++){
+      if (fread(member, sizeof(CCTK_REAL), num_samples, file) != (size_t)num_samples)
+        CCTK_VERROR("Could not read member %d of the TOVola star library '%s'.", i0+a, TOVola_star_library);
+      for(int k=0; k<num_samples; k++) fields[f][k] += w[a] * member[k];
+    }
+  }
+  free(member);
+  free(rho_c);
+  const CCTK_REAL *const scalars[4] = {member_scalars[0], member_scalars[1], member_scalars[2], member_scalars[3]};
+  for(int f=0; f<TOVOLA_LIBRARY_NUM_FIELDS; f++){
+    if (!TOVOLA_LIBRARY_SCALED(f)) continue;
+    const CCTK_REAL central = TOVola_library_blend_scalar(w, scalars, TOVOLA_LIBRARY_CENTRAL(f));
+    for(int k=0; k<num_samples; k++) fields[f][k] *= central;
+  }
+  free(offsets);
+  fclose(file);
+
+  // Mirror a few samples to r<0, so that interpolation never has to extrapolate to r=0
+  extend_to_negative_r(TOVola_ID_persist->r_Schw_arr, -1.0, num_samples);
+  extend_to_negative_r(TOVola_ID_persist->r_iso_arr, -1.0, num_samples);
+  extend_to_negative_r(TOVola_ID_persist->rho_energy_arr, +1.0, num_samples);
+  extend_to_negative_r(TOVola_ID_persist->rho_baryon_arr, +1.0, num_samples);
+  extend_to_negative_r(TOVola_ID_persist->P_arr, +1.0, num_samples);
+  extend_to_negative_r(TOVola_ID_persist->M_arr, +1.0, num_samples);
+  extend_to_negative_r(TOVola_ID_persist->expnu_arr, +1.0, num_samples);
+  extend_to_negative_r(TOVola_ID_persist->exp4phi_arr, +1.0, num_samples);
+
+  TOVola_ID_persist->baryon_mass = TOVola_library_blend_scalar(w, scalars, TOVOLA_LIBRARY_BARYON_MASS);
+  TOVola_ID_persist->moment_of_inertia = TOVola_library_blend_scalar(w, scalars, TOVOLA_LIBRARY_MOMENT_OF_INERTIA);
+  TOVola_ID_persist->love_k2 = TOVola_library_blend_scalar(w, scalars, TOVOLA_LIBRARY_LOVE_K2);
+  CCTK_VINFO("Interpolated the rho_c = %.14e profile from the TOVola star library '%s': M = %.14e, R_Schw = %.14e.", central_baryon_density,
+             TOVola_star_library, TOVola_ID_persist->M_arr[numpoints-1], TOVola_ID_persist->r_Schw_arr[numpoints-1]);
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+//This header file holds the HDF5 writer for the 1D TOV profile. Each solved profile becomes one group of the file,
+//with the raw ODE samples, the normalized profile placed on the grid, and the parameters and solver statistics as attributes.
+//Only the integrated samples are written, not the mirrored r<0 buffer kept for interpolation.
+
+#include "TOVola_defines.h"
+#include "TOVola_solve.h"
+#include "TOVola_output_path.h"
+#include <string.h>
+#include <stdio.h>
+#include <hdf5.h>
+
+#include <cctk.h>
+#include <cctk_Parameters.h>
+
+static inline void TOVola_h5_write_array(const hid_t group, const char *name, const CCTK_REAL *restrict data, const hsize_t n){
+  const hid_t space = H5Screate_simple(1, &n, NULL);
+  const hid_t dset = H5Dcreate2(group, name, H5T_NATIVE_DOUBLE, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  H5Dwrite(dset, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, data);
+  H5Dclose(dset);
+  H5Sclose(space);
+}
+
+static inline void TOVola_h5_attr_real(const hid_t loc, const char *name, const CCTK_REAL value){
+  const hid_t space = H5Screate(H5S_SCALAR);
+  const hid_t attr = H5Acreate2(loc, name, H5T_NATIVE_DOUBLE, space, H5P_DEFAULT, H5P_DEFAULT);
+  H5Awrite(attr, H5T_NATIVE_DOUBLE, &value);
+  H5Aclose(attr);
+  H5Sclose(space);
+}
+
+static inline void TOVola_h5_attr_long(const hid_t loc, const char *name, const long value){
+  const hid_t space = H5Screate(H5S_SCALAR);
+  const hid_t attr = H5Acreate2(loc, name, H5T_NATIVE_LONG, space, H5P_DEFAULT, H5P_DEFAULT);
+  H5Awrite(attr, H5T_NATIVE_LONG, &value);
+  H5Aclose(attr);
+  H5Sclose(space);
+}
+
+static inline void TOVola_h5_attr_string(const hid_t loc, const char *name, const char *value){
+  const hid_t type = H5Tcopy(H5T_C_S1);
+  H5Tset_size(type, strlen(value)+1);
+  const hid_t space = H5Screate(H5S_SCALAR);
+  const hid_t attr = H5Acreate2(loc, name, type, space, H5P_DEFAULT, H5P_DEFAULT);
+  H5Awrite(attr, type, value);
+  H5Aclose(attr);
+  H5Sclose(space);
+  H5Tclose(type);
+}
+
+//Write profile number profile_index as group /profile_<index>. The first profile creates (truncates) the file, later ones are added to it.
+//Called from the solve while the raw samples still exist. Output problems are reported, not fatal.
+static inline void TOVola_write_profile_h5(const int profile_index, const TOVola_data_struct *restrict TOVdata,
+                                    const TOVola_ID_persist_struct *restrict TOVola_ID_persist){
+
+  DECLARE_CCTK_PARAMETERS;
+
+  if (CCTK_MyProc(NULL) != 0) return;
+  char path[4096], group_name[64];
+  TOVola_output_path(path, sizeof(path), TOVola_profile_filename);
+  snprintf(group_name, sizeof(group_name), "profile_%d", profile_index);
+
+  const hid_t file = profile_index == 0 ? H5Fcreate(path, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT)
+                                        : H5Fopen(path, H5F_ACC_RDWR, H5P_DEFAULT);
+  if (file < 0) {
+    CCTK_VWARN(CCTK_WARN_ALERT, "Could not open the TOVola profile file '%s'.", path);
+    return;}
+  const hid_t group = H5Gcreate2(file, group_name, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  if (group < 0) {
+    CCTK_VWARN(CCTK_WARN_ALERT, "Could not create group '%s' in the TOVola profile file '%s'.", group_name, path);
+    H5Fclose(file);
+    return;}
+
+  //Both the raw and the normalized arrays start with the mirrored buffer; skip it.
+  const int first = NEGATIVE_R_INTERP_BUFFER;
+  const hsize_t n = TOVdata->numpoints_actually_saved - first;
+  const int surface = TOVola_ID_persist->numpoints_arr - 1;
+
+  /* Raw ODE samples: nu and r_iso as integrated, before matching to the exterior */
+  const hid_t raw = H5Gcreate2(group, "raw", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  TOVola_h5_write_array(raw, "r_Schw", &TOVdata->rSchw_arr[first], n);
+  TOVola_h5_write_array(raw, "r_iso", &TOVdata->Iso_r_arr[first], n);
+  TOVola_h5_write_array(raw, "rho_baryon", &TOVdata->rho_baryon_arr[first], n);
+  TOVola_h5_write_array(raw, "rho_energy", &TOVdata->rho_energy_arr[first], n);
+  TOVola_h5_write_array(raw, "P", &TOVdata->P_arr[first], n);
+  TOVola_h5_write_array(raw, "M", &TOVdata->M_arr[first], n);
+  TOVola_h5_write_array(raw, "nu", &TOVdata->nu_arr[first], n);
+  H5Gclose(raw);
+
+  /* Normalized profile, as interpolated to the grid */
+  const hid_t normalized = H5Gcreate2(group, "normalized", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  TOVola_h5_write_array(normalized, "r_Schw", &TOVola_ID_persist->r_Schw_arr[first], n);
+  TOVola_h5_write_array(normalized, "r_iso", &TOVola_ID_persist->r_iso_arr[first], n);
+  TOVola_h5_write_array(normalized, "rho_baryon", &TOVola_ID_persist->rho_baryon_arr[first], n);
+  TOVola_h5_write_array(normalized, "rho_energy", &TOVola_ID_persist->rho_energy_arr[first], n);
+  TOVola_h5_write_array(normalized, "P", &TOVola_ID_persist->P_arr[first], n);
+  TOVola_h5_write_array(normalized, "M", &TOVola_ID_persist->M_arr[first], n);
+  TOVola_h5_write_array(normalized, "expnu", &TOVola_ID_persist->expnu_arr[first], n);
+  TOVola_h5_write_array(normalized, "exp4phi", &TOVola_ID_persist->exp4phi_arr[first], n);
+  H5Gclose(normalized);
+
+  /* Parameters */
+  TOVola_h5_attr_string(group, "EOS_type", TOVola_EOS_type);
+  TOVola_h5_attr_string(group, "ODE_method", TOVola_ODE_method);
+  TOVola_h5_attr_real(group, "central_baryon_density", TOVdata->central_baryon_density);
+  TOVola_h5_attr_real(group, "error_limit", TOVdata->error_limit);
+  TOVola_h5_attr_real(group, "initial_ode_step_size", TOVdata->initial_ode_step_size);
+  TOVola_h5_attr_real(group, "absolute_min_step", TOVdata->absolute_min_step);
+  TOVola_h5_attr_real(group, "absolute_max_step", TOVdata->absolute_max_step);
+  TOVola_h5_attr_real(group, "Tin", TOVola_Tin);
+
+  /* Solver statistics and the resulting star */
+  TOVola_h5_attr_long(group, "num_samples", (long)n);
+  TOVola_h5_attr_long(group, "num_rhs_evaluations", TOVdata->num_rhs_evaluations);
+  TOVola_h5_attr_real(group, "mass", TOVola_ID_persist->M_arr[surface]);
+  TOVola_h5_attr_real(group, "baryon_mass", TOVola_ID_persist->baryon_mass);
+  TOVola_h5_attr_real(group, "radius_Schw", TOVola_ID_persist->r_Schw_arr[surface]);
+  TOVola_h5_attr_real(group, "radius_iso", TOVola_ID_persist->r_iso_arr[surface]);
+  if (TOVdata->observables) {
+    TOVola_h5_attr_real(group, "moment_of_inertia", TOVdata->moment_of_inertia);
+    TOVola_h5_attr_real(group, "love_k2", TOVdata->love_k2);
+  }
+  if (TOVdata->sensitivities) {
+    TOVola_h5_attr_real(group, "dmass_drho_c", TOVdata->dmass_drho_c);
+    TOVola_h5_attr_real(group, "dradius_Schw_drho_c", TOVdata->dradius_drho_c);
+  }
+
+  H5Gclose(group);
+  H5Fclose(file);
+  CCTK_VINFO("Wrote TOV profile %d to '%s'.", profile_index, path);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+//This header file holds the location of the files that TOVola writes, shared by the HDF5 profile writer and the sequence table.
+
+#include <stdio.h>
+
+#include <cctk.h>
+
+//Path of an output file of TOVola: in IO::out_dir when an IO thorn is active, else in the current directory.
+static inline void TOVola_output_path(char *restrict path, const size_t len, const char *filename){
+  const char *out_dir = ".";
+  if (CCTK_IsImplementationActive("IO")){
+    int type;
+    const void *value = CCTK_ParameterGet("out_dir", "IO", &type);
+    if (value && type == PARAMETER_STRING) out_dir = *(const char *const *)value;
+  }
+  CCTK_CreateDirectory(0755, out_dir);
+  snprintf(path, len, "%s/%s", out_dir, filename);
+}
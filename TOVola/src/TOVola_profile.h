@@ -0,0 +1,25 @@
+#pragma once
+
+//Public header of TOVola's profile queries, for thorns that call the aliased functions declared in interface.ccl:
+//
+//  CCTK_INT TOVola_InterpolateProfile(star, npoints, r_iso[npoints], nfields, fields[nfields], values[nfields*npoints])
+//      Fills values[f*npoints + p] with field fields[f] of star number star at isotropic radius r_iso[p] from its center.
+//      Radii outside the star get the Schwarzschild exterior. Returns 0, or a negative TOVOLA_PROFILE_ERROR_* code.
+//  CCTK_REAL TOVola_GetMass(star), TOVola_GetRadiusSchw(star), TOVola_GetRadiusIso(star), TOVola_GetBaryonMass(star)
+//      Gravitational mass, Schwarzschild and isotropic radii of the surface, and baryon mass. Negative for an invalid star.
+//
+//Stars are numbered from 0 to TOVola_num_stars-1. The first query integrates the TOV equations if TOVola has not done so yet.
+
+/* Field codes for TOVola_InterpolateProfile */
+#define TOVOLA_PROFILE_RHO_BARYON 0
+#define TOVOLA_PROFILE_RHO_ENERGY 1
+#define TOVOLA_PROFILE_PRESSURE 2
+#define TOVOLA_PROFILE_MASS 3     // Enclosed gravitational mass m(r)
+#define TOVOLA_PROFILE_R_SCHW 4   // Schwarzschild (areal) radius
+#define TOVOLA_PROFILE_LAPSE 5
+#define TOVOLA_PROFILE_EXP4PHI 6  // Conformal factor psi^4 = g_xx = g_yy = g_zz
+#define TOVOLA_PROFILE_NUM_FIELDS 7
+
+/* Error codes */
+#define TOVOLA_PROFILE_ERROR_STAR -1
+#define TOVOLA_PROFILE_ERROR_FIELD -2
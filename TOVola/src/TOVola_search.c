@@ -0,0 +1,278 @@
+//Searches over the central density. With TOVola_target_mass or TOVola_target_baryon_mass, the central density of the star on the
+//stable branch that has the requested mass is found by a bracketed Brent iteration in log(rho_c), starting from
+//TOVola_central_baryon_density as the initial guess; a bracketing step that overshoots the maximum mass is resolved by the golden
+//section search below, to TOVola_maximum_mass_tolerance. All trial solves share one TOVola_data_struct, so the arrays and the GSL
+//driver are allocated once, and each trial is warm-started from the size of the previous star.
+//TOVola_Maximum_Mass locates the maximum-mass star of the EOS in the same way, with a golden section search.
+
+#include "GRHayLib.h"
+#include "TOVola_defines.h"
+#include "TOVola_solve.h"
+#include <stdlib.h>
+#include <math.h>
+
+#include <cctk.h>
+#include <cctk_Arguments.h>
+#include <cctk_Parameters.h>
+
+// The first sampling interval of a warm-started trial, relative to the radius of the previous trial star
+#define TOVOLA_WARM_START_FRACTION 1.0e-5
+// Bracketing steps in log(rho_c)
+#define TOVOLA_SEARCH_BRACKET_STEP 0.6931471805599453 // log(2)
+#define TOVOLA_SEARCH_MAX_ITERATIONS 100
+
+/* State of a search: the shared solver and the quantity that is matched */
+typedef struct {
+  TOVola_data_struct TOVdata;
+  int use_baryon_mass;
+  CCTK_REAL target;
+  int num_solves;
+  TOVola_sequence_star_struct star; // Last trial star
+} TOVola_search_struct;
+
+//Mass (or baryon mass) of the star with central density exp(x), minus the target
+static CCTK_REAL TOVola_search_residual(TOVola_search_struct *restrict search, const CCTK_REAL x){
+  TOVola_surface_solve(&search->TOVdata, exp(x), &search->star);
+  search->TOVdata.warm_start_lengthscale = TOVOLA_WARM_START_FRACTION * search->star.radius_Schw;
+  search->num_solves++;
+  return (search->use_baryon_mass ? search->star.baryon_mass : search->star.mass) - search->target;
+}
+
+/* Golden section search in x = log(rho_c) for the maximum of the residual on [x0,x3], which contains the point xc of residual
+   fc and star star_c. It stops at a bracket narrower than tol, or, if stop_at_target, at the first residual >= 0.
+   The best point is returned in *x_best, *f_best and *star_best. */
+static void TOVola_search_golden(TOVola_search_struct *restrict search, CCTK_REAL x0, CCTK_REAL x3, const CCTK_REAL xc, const CCTK_REAL fc,
+                                 const TOVola_sequence_star_struct *restrict star_c, const CCTK_REAL tol, const int stop_at_target,
+                                 CCTK_REAL *restrict x_best, CCTK_REAL *restrict f_best, TOVola_sequence_star_struct *restrict star_best){
+  const CCTK_REAL R = 0.61803398874989485, C = 1.0 - R;
+  CCTK_REAL x1, x2, f1, f2;
+  TOVola_sequence_star_struct star1, star2;
+  if (x3 - xc > xc - x0) {
+    x1 = xc; f1 = fc; star1 = *star_c;
+    x2 = xc + C*(x3 - xc); f2 = TOVola_search_residual(search, x2); star2 = search->star;
+  } else {
+    x2 = xc; f2 = fc; star2 = *star_c;
+    x1 = xc - C*(xc - x0); f1 = TOVola_search_residual(search, x1); star1 = search->star;
+  }
+  while (x3 - x0 > tol && !(stop_at_target && (f1 >= 0 || f2 >= 0))) {
+    if (f2 > f1) {
+      x0 = x1;
+      x1 = x2; f1 = f2; star1 = star2;
+      x2 = R*x2 + C*x3; f2 = TOVola_search_residual(search, x2); star2 = search->star;
+    } else {
+      x3 = x2;
+      x2 = x1; f2 = f1; star2 = star1;
+      x1 = R*x1 + C*x0; f1 = TOVola_search_residual(search, x1); star1 = search->star;
+    }
+  }
+  if (f1 > f2) {
+    *x_best = x1; *f_best = f1; *star_best = star1;
+  } else {
+    *x_best = x2; *f_best = f2; *star_best = star2;
+  }
+}
+
+//Central density of the stable star with the target mass, on the first call; later calls return the same value.
+//Aborts if the target exceeds the maximum mass reached by the stable branch.
+CCTK_REAL TOVola_target_central_density(void){
+
+  DECLARE_CCTK_PARAMETERS;
+  static CCTK_REAL rho_c = -1.0;
+
+  if (rho_c > 0) return rho_c;
+  if (TOVola_target_mass > 0 && TOVola_target_baryon_mass > 0)
+    CCTK_ERROR("Set at most one of TOVola_target_mass and TOVola_target_baryon_mass.");
+
+  TOVola_search_struct search;
+  TOVola_set_solver_parameters(&search.TOVdata, TOVola_init_eos(), TOVola_central_baryon_density);
+  search.TOVdata.store_derivatives = 0;
+  search.use_baryon_mass = TOVola_target_baryon_mass > 0;
+  search.target = search.use_baryon_mass ? TOVola_target_baryon_mass : TOVola_target_mass;
+  search.num_solves = 0;
+  const char *name = search.use_baryon_mass ? "baryon mass" : "mass";
+  const CCTK_REAL tol = TOVola_target_mass_tolerance * search.target;
+
+  /* Bracket the root, [a,b] with f(a) < 0 <= f(b), such that the only root in it is on the stable branch.
+     Below the target, walk along the direction in which the mass grows: up the stable branch, or down the unstable one.
+     When the mass stops growing, the step has passed the maximum, which the golden section search then locates; either it
+     reaches the target on the way, or the target is above the maximum mass. Above the target, walk down. */
+  CCTK_REAL a = 0, b, fa = 0, fb;
+  CCTK_REAL x = log(TOVola_central_baryon_density);
+  CCTK_REAL f = TOVola_search_residual(&search, x);
+  TOVola_sequence_star_struct star = search.star;
+  CCTK_REAL step = TOVOLA_SEARCH_BRACKET_STEP;
+  int turned = 0, have_a = 0, have_prev = 0;
+  CCTK_REAL x_prev = 0, f_prev = 0;
+  while (f < 0) {
+    const CCTK_REAL x_next = x + step;
+    const CCTK_REAL f_next = TOVola_search_residual(&search, x_next);
+    if (!(f_next > f)) {
+      //The mass does not grow from x to x_next. If it grows from x_prev to x, the maximum lies between x_prev and x_next.
+      if (!have_prev) {
+        x_prev = x - step;
+        f_prev = TOVola_search_residual(&search, x_prev);
+        have_prev = 1;
+      }
+      if (!(f_prev < f)) {
+        if (turned) CCTK_ERROR("Could not bracket the TOVola target mass.");
+        step = -step; // The mass falls with density around x: the guess is on the unstable branch
+        turned = 1;
+        //The point at x - step is still known, as the one before x in the new direction.
+        x_prev = x_next;
+        f_prev = f_next;
+        continue;
+      }
+      CCTK_REAL x_max, f_max;
+      TOVola_sequence_star_struct star_max;
+      TOVola_search_golden(&search, MIN(x_prev, x_next), MAX(x_prev, x_next), x, f, &star, TOVola_maximum_mass_tolerance, 1,
+                           &x_max, &f_max, &star_max);
+      if (f_max < 0)
+        CCTK_VERROR("TOVola_target_%s = %.6e is above the maximum %s of %.6e for this EOS, at rho_c = %.6e.",
+                    search.use_baryon_mass ? "baryon_mass" : "mass", search.target, name, f_max + search.target, exp(x_max));
+      //The lower-density end of the bracket is on the stable branch, below the target: the root lies between it and x_max.
+      have_a = 1;
+      a = step > 0 ? x_prev : x_next;
+      fa = step > 0 ? f_prev : f_next;
+      x = x_max;
+      f = f_max;
+      break;
+    }
+    //Walking up the stable branch, the last point below the target closes the bracket.
+    have_a = step > 0;
+    x_prev = x;
+    f_prev = f;
+    have_prev = 1;
+    a = x;
+    fa = f;
+    x = x_next;
+    f = f_next;
+    star = search.star;
+    if (search.num_solves > TOVOLA_SEARCH_MAX_ITERATIONS) CCTK_ERROR("Could not bracket the TOVola target mass.");
+  }
+  b = x;
+  fb = f;
+  while (!have_a) {
+    a = b - fabs(step);
+    fa = TOVola_search_residual(&search, a);
+    if (fa < 0) have_a = 1;
+    else {
+      b = a;
+      fb = fa;
+    }
+    if (search.num_solves > TOVOLA_SEARCH_MAX_ITERATIONS) CCTK_ERROR("Could not bracket the TOVola target mass.");
+  }
+
+  /* Brent's method: inverse quadratic or secant steps, safeguarded by bisection */
+  CCTK_REAL c = a, fc = fa, d = b - a, e = d;
+  for (int it = 0; it < TOVOLA_SEARCH_MAX_ITERATIONS; it++) {
+    if ((fb > 0 && fc > 0) || (fb < 0 && fc < 0)) {
+      c = a; fc = fa; d = b - a; e = d;
+    }
+    if (fabs(fc) < fabs(fb)) {
+      a = b; b = c; c = a;
+      fa = fb; fb = fc; fc = fa;
+    }
+    const CCTK_REAL tol_x = 1.0e-14 * fmax(1.0, fabs(b));
+    const CCTK_REAL m = 0.5 * (c - b);
+    if (fabs(fb) <= tol || fabs(m) <= tol_x) break;
+    if (fabs(e) >= tol_x && fabs(fa) > fabs(fb)) {
+      CCTK_REAL p, q;
+      const CCTK_REAL s = fb / fa;
+      if (a == c) {
+        p = 2.0 * m * s;
+        q = 1.0 - s;
+      } else {
+        const CCTK_REAL r = fb / fc;
+        const CCTK_REAL t = fa / fc;
+        p = s * (2.0 * m * t * (t - r) - (b - a) * (r - 1.0));
+        q = (t - 1.0) * (r - 1.0) * (s - 1.0);
+      }
+      if (p > 0) q = -q;
+      else p = -p;
+      if (2.0 * p < fmin(3.0 * m * q - fabs(tol_x * q), fabs(e * q))) {
+        e = d;
+        d = p / q;
+      } else {
+        d = m;
+        e = d;
+      }
+    } else {
+      d = m;
+      e = d;
+    }
+    a = b;
+    fa = fb;
+    b += fabs(d) > tol_x ? d : (m > 0 ? tol_x : -tol_x);
+    fb = TOVola_search_residual(&search, b);
+  }
+
+  rho_c = exp(b);
+  CCTK_VINFO("Target %s %.14e: central baryon density %.14e gives %s %.14e after %d solves.", name, search.target, rho_c,
+             name, fb + search.target, search.num_solves);
+  free_tovola_data(&search.TOVdata);
+  return rho_c;
+}
+
+//Maximum-mass (TOV limit) star of the EOS. A coarse scan of TOVola_maximum_mass_scan_points log-spaced central densities,
+//shared among the OpenMP threads with one reusable TOVola_data_struct each, brackets the turning point of M(rho_c); a golden
+//section search in log(rho_c) on a single warm-started TOVola_data_struct then narrows it to TOVola_maximum_mass_tolerance.
+//The star is reported, and stored in the TOVola_maximum_mass_star grid scalars.
+void TOVola_Maximum_Mass(CCTK_ARGUMENTS){
+
+  DECLARE_CCTK_ARGUMENTS;
+  DECLARE_CCTK_PARAMETERS;
+
+  //Independent of the grid, and cheap: every process searches, so that each holds the star in its grid scalars.
+
+  const int n = TOVola_maximum_mass_scan_points;
+  const CCTK_REAL log_min = log(TOVola_maximum_mass_min_central_baryon_density);
+  const CCTK_REAL log_max = log(TOVola_maximum_mass_max_central_baryon_density);
+  if (!(log_max > log_min))
+    CCTK_ERROR("TOVola_maximum_mass_max_central_baryon_density must be larger than TOVola_maximum_mass_min_central_baryon_density.");
+  const int eos_type = TOVola_init_eos();
+
+  /* Coarse scan */
+  TOVola_sequence_star_struct *restrict scan = (TOVola_sequence_star_struct *restrict)malloc(sizeof(TOVola_sequence_star_struct) * n);
+  if (!scan) CCTK_ERROR("Memory allocation failed for the TOVola maximum-mass scan.");
+#pragma omp parallel
+  {
+    TOVola_data_struct TOVdata;
+    TOVola_set_solver_parameters(&TOVdata, eos_type, TOVola_central_baryon_density);
+    TOVdata.store_derivatives = 0;
+#pragma omp for schedule(dynamic,1)
+    for(int s=0; s<n; s++) TOVola_surface_solve(&TOVdata, exp(log_min + (log_max - log_min)*s/(n - 1)), &scan[s]);
+    free_tovola_data(&TOVdata);
+  }
+  int i_max = 0;
+  for(int s=1; s<n; s++)
+    if (scan[s].mass > scan[i_max].mass) i_max = s;
+  if (i_max == 0 || i_max == n-1) {
+    free(scan);
+    CCTK_VERROR("The maximum mass lies outside TOVola_maximum_mass_min/max_central_baryon_density: the largest mass of the scan "
+                "is at rho_c = %.6e, at the end of the range.", exp(i_max == 0 ? log_min : log_max));
+  }
+
+  /* Golden section search in x = log(rho_c) on the bracket around the coarse maximum */
+  TOVola_search_struct search;
+  TOVola_set_solver_parameters(&search.TOVdata, eos_type, TOVola_central_baryon_density);
+  search.TOVdata.store_derivatives = 0;
+  search.use_baryon_mass = 0;
+  search.target = 0.0; // TOVola_search_residual then returns the mass itself
+  search.num_solves = 0;
+
+  CCTK_REAL x_max, M_max;
+  TOVola_sequence_star_struct star;
+  TOVola_search_golden(&search, log(scan[i_max-1].central_baryon_density), log(scan[i_max+1].central_baryon_density),
+                       log(scan[i_max].central_baryon_density), scan[i_max].mass, &scan[i_max], TOVola_maximum_mass_tolerance, 0,
+                       &x_max, &M_max, &star);
+  free_tovola_data(&search.TOVdata);
+  free(scan);
+
+  CCTK_VINFO("Maximum-mass star after %d scan and %d golden-section solves: rho_c = %.14e, M = %.14e, M_baryon = %.14e, "
+             "R_Schw = %.14e, R_iso = %.14e", n, search.num_solves, exp(x_max), M_max, star.baryon_mass, star.radius_Schw, star.radius_iso);
+  *TOVola_maximum_mass_rho_c = exp(x_max);
+  *TOVola_maximum_mass = M_max;
+  *TOVola_maximum_mass_baryon = star.baryon_mass;
+  *TOVola_maximum_mass_R_Schw = star.radius_Schw;
+  *TOVola_maximum_mass_R_iso = star.radius_iso;
+}
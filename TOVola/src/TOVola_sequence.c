@@ -0,0 +1,103 @@
+//Mass-radius sequence mode. TOVola_sequence_num_stars stars with central densities spaced logarithmically between
+//TOVola_sequence_min_central_baryon_density and TOVola_sequence_max_central_baryon_density are integrated in parallel, one star
+//per OpenMP thread at a time with its own reused TOVola_data_struct, and their surface quantities are written as an ASCII table.
+//Only the 1D integration is done: no profile is normalized and no grid function is touched.
+//With TOVola_sequence_integrator = "lanes", each thread instead advances TOVOLA_LANES polytropic stars together (TOVola_lanes.h).
+
+#include "GRHayLib.h"
+#include "TOVola_defines.h"
+#include "TOVola_solve.h"
+#include "TOVola_output_path.h"
+#include "TOVola_lanes.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <cctk.h>
+#include <cctk_Arguments.h>
+#include <cctk_Parameters.h>
+
+void TOVola_Sequence(CCTK_ARGUMENTS){
+
+  DECLARE_CCTK_PARAMETERS;
+
+  //The sequence does not depend on the grid, so one process does all of it.
+  if (CCTK_MyProc(NULL) != 0) return;
+
+  const int n = TOVola_sequence_num_stars;
+  const CCTK_REAL log_min = log(TOVola_sequence_min_central_baryon_density);
+  const CCTK_REAL log_max = log(TOVola_sequence_max_central_baryon_density);
+  if (n > 1 && !(log_max > log_min))
+    CCTK_ERROR("TOVola_sequence_max_central_baryon_density must be larger than TOVola_sequence_min_central_baryon_density.");
+
+  TOVola_sequence_star_struct *restrict stars = (TOVola_sequence_star_struct *restrict)malloc(sizeof(TOVola_sequence_star_struct) * n);
+  if (!stars) CCTK_ERROR("Memory allocation failed for the TOVola sequence.");
+
+  //Set up the EOS (and the tabulated beta-equilibrium slice) before the threads start.
+  const int eos_type = TOVola_init_eos();
+  CCTK_VINFO("Solving a sequence of %d TOV stars in %.6e <= rho_c <= %.6e...", n,
+             TOVola_sequence_min_central_baryon_density, TOVola_sequence_max_central_baryon_density);
+
+  CCTK_REAL *restrict rho_c = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * n);
+  if (!rho_c) CCTK_ERROR("Memory allocation failed for the TOVola sequence.");
+  for(int s=0; s<n; s++)
+    rho_c[s] = n > 1 ? exp(log_min + (log_max - log_min)*s/(n - 1)) : TOVola_sequence_min_central_baryon_density;
+
+  if (CCTK_EQUALS("lanes",TOVola_sequence_integrator)){
+    if (eos_type == 2) CCTK_ERROR("TOVola_sequence_integrator = \"lanes\" requires a Simple or Piecewise EOS.");
+    if (TOVola_sensitivities || TOVola_observables)
+      CCTK_ERROR("TOVola_sensitivities and TOVola_observables require TOVola_sequence_integrator = \"GSL\".");
+    TOVola_lanes_eos_struct leos;
+    TOVola_lanes_set_eos(ghl_eos, &leos);
+    const TOVola_lanes_params_struct params = {TOVola_error_limit, TOVola_initial_ode_step_size, TOVola_absolute_min_step,
+                                               TOVola_absolute_max_step, TOVola_size};
+    //Every thread refills its lanes from the same queue of stars.
+    int next = 0;
+#pragma omp parallel
+    TOVola_lanes_solve(&leos, &params, n, rho_c, &next, stars);
+  }
+  else {
+    //Denser stars need more steps, so hand out one star at a time. Each thread reuses one solver context for all of its stars.
+#pragma omp parallel
+    {
+      TOVola_data_struct TOVdata;
+      TOVola_set_solver_parameters(&TOVdata, eos_type, TOVola_central_baryon_density);
+      TOVdata.store_derivatives = 0; // Only the surface is needed
+#pragma omp for schedule(dynamic,1)
+      for(int s=0; s<n; s++) TOVola_surface_solve(&TOVdata, rho_c[s], &stars[s]);
+      free_tovola_data(&TOVdata);
+    }
+  }
+
+  //The cost depends on the integrator and its step history, so it is reported instead of tabulated.
+  long num_rhs_evaluations = 0;
+  for(int s=0; s<n; s++) num_rhs_evaluations += stars[s].num_rhs_evaluations;
+  CCTK_VINFO("Solved %d TOV stars with %ld right-hand-side evaluations.", n, num_rhs_evaluations);
+
+  //Write the table; an output problem is reported, not fatal.
+  char path[4096];
+  TOVola_output_path(path, sizeof(path), TOVola_sequence_filename);
+  FILE *file = fopen(path, "w");
+  if (!file) {
+    CCTK_VWARN(CCTK_WARN_ALERT, "Could not open the TOVola sequence file '%s'.", path);
+  }
+  else {
+    fprintf(file, "# TOVola mass-radius sequence, EOS type %s, %d stars\n", TOVola_EOS_type, n);
+    //Optional columns follow in the order observables, sensitivities.
+    fprintf(file, "# 1:rho_c 2:M 3:M_baryon 4:R_Schw 5:R_iso%s%s\n",
+            TOVola_observables ? " 6:I 7:k2" : "",
+            TOVola_sensitivities ? (TOVola_observables ? " 8:dM/drho_c 9:dR_Schw/drho_c" : " 6:dM/drho_c 7:dR_Schw/drho_c") : "");
+    for(int s=0; s<n; s++){
+      fprintf(file, "%.17e %.17e %.17e %.17e %.17e", stars[s].central_baryon_density, stars[s].mass, stars[s].baryon_mass,
+              stars[s].radius_Schw, stars[s].radius_iso);
+      if (TOVola_observables) fprintf(file, " %.17e %.17e", stars[s].moment_of_inertia, stars[s].love_k2);
+      if (TOVola_sensitivities) fprintf(file, " %.17e %.17e", stars[s].dmass_drho_c, stars[s].dradius_drho_c);
+      fprintf(file, "\n");
+    }
+    fclose(file);
+    CCTK_VINFO("Wrote the TOV sequence to '%s'.", path);
+  }
+
+  free(rho_c);
+  free(stars);
+}
@@ -20,6 +20,19 @@
 #define TOVOLA_NU 1
 #define TOVOLA_MASS 2
 #define TOVOLA_R_ISO 3
+// Optional stellar observables: baryon mass, frame dragging omega-bar and its flux j r^4 domega-bar/dr, and y = r H'/H of the
+// static tidal perturbation H
+#define TOVOLA_BARYON_MASS 4
+#define TOVOLA_OMEGA 5
+#define TOVOLA_OMEGA_FLUX 6
+#define TOVOLA_TIDAL_Y 7
+#define TOVOLA_NUM_OBSERVABLES 4
+// Optional forward sensitivities with respect to the central baryon density: delta(m), shifted as in TOVola_sensitivity_rhs,
+// and delta(H), H = int dP/(e+P). They follow the components in use, at offsets from TOVdata->sensitivity_index.
+#define TOVOLA_DMASS 0
+#define TOVOLA_DENTHALPY 1
+#define TOVOLA_NUM_SENSITIVITIES 2
+#define ODE_SOLVER_MAX_DIM (ODE_SOLVER_DIM + TOVOLA_NUM_OBSERVABLES + TOVOLA_NUM_SENSITIVITIES)
 #define NEGATIVE_R_INTERP_BUFFER 11
 
 /* Structure to hold raw TOV data */
@@ -40,6 +53,12 @@ typedef struct {
   CCTK_REAL *restrict M_arr;
   CCTK_REAL *restrict nu_arr;
   CCTK_REAL *restrict Iso_r_arr;
+  // ODE right-hand side at each sample (only with store_derivatives, else NULL)
+  int store_derivatives;
+  CCTK_REAL *restrict dPdr_arr;
+  CCTK_REAL *restrict dnudr_arr;
+  CCTK_REAL *restrict dMdr_arr;
+  CCTK_REAL *restrict dIso_rdr_arr;
   int numels_alloced_TOV_arr;
   ghl_eos_parameters *restrict ghl_eos;
   int numpoints_actually_saved;
@@ -51,10 +70,35 @@ typedef struct {
   CCTK_REAL absolute_min_step;
   CCTK_REAL absolute_max_step;
 
+  // Solver statistics
+  long num_rhs_evaluations;
+
+  // Report the progress of the integration through CCTK_INFO; off for the solves of a sequence
+  int verbose;
+
+  // Integrate the observables too, and their results at the surface
+  int observables;
+  CCTK_REAL baryon_mass;
+  CCTK_REAL moment_of_inertia;
+  CCTK_REAL love_k2;
+
+  // Integrate the sensitivity equations too, and their results at the surface
+  int sensitivities;
+  int sensitivity_index;
+  CCTK_REAL central_pressure;
+  CCTK_REAL dmass_drho_c;
+  CCTK_REAL dradius_drho_c;
+
+  // GSL system and driver, kept with the arrays between integrations of the same TOVdata (freed by free_tovola_data)
+  gsl_odeiv2_system system;
+  gsl_odeiv2_driver *driver;
+  // If positive, the first sampling interval of the next integration is based on this length instead of initial_ode_step_size
+  CCTK_REAL warm_start_lengthscale;
+
 } TOVola_data_struct;
 
 /* Exception handler to prevent negative pressures */
-static void TOVola_exception_handler(CCTK_REAL r, CCTK_REAL y[]) {
+static inline void TOVola_exception_handler(CCTK_REAL r, CCTK_REAL y[]) {
   // Ensure pressure does not become negative due to numerical errors
   if (y[TOVOLA_PRESSURE] < 0) {
     y[TOVOLA_PRESSURE] = 0;
@@ -62,7 +106,7 @@ static void TOVola_exception_handler(CCTK_REAL r, CCTK_REAL y[]) {
 }
 
 /* Termination condition for the integration */
-static int TOVola_do_we_terminate(CCTK_REAL r, CCTK_REAL y[], TOVola_data_struct *TOVdata) {
+static inline int TOVola_do_we_terminate(CCTK_REAL r, CCTK_REAL y[], TOVola_data_struct *TOVdata) {
   
   if (TOVdata->eos_type == 2) {
   	const CCTK_REAL PMin = exp(TOVdata->ghl_eos->lp_of_lr[0]); //PMin is not zero on the table, so we don't want to exceed table limits
@@ -80,7 +124,7 @@ static int TOVola_do_we_terminate(CCTK_REAL r, CCTK_REAL y[], TOVola_data_struct
 }
 
 /* Evaluate rho_baryon and rho_energy based on the EOS type */
-static void TOVola_evaluate_rho_and_eps(CCTK_REAL r, const CCTK_REAL y[], TOVola_data_struct *TOVdata) {
+static inline void TOVola_evaluate_rho_and_eps(CCTK_REAL r, const CCTK_REAL y[], TOVola_data_struct *TOVdata) {
   
   // Simple Polytrope
   if (TOVdata->eos_type == 0) {
@@ -126,10 +170,101 @@ static void TOVola_evaluate_rho_and_eps(CCTK_REAL r, const CCTK_REAL y[], TOVola
   }
 }
 
+/* Adiabatic index dlnP/dln(rho_baryon) of the cold EOS at rho_baryon */
+static inline CCTK_REAL TOVola_Gamma_eff(const TOVola_data_struct *TOVdata, const CCTK_REAL rho_baryon) {
+  if (TOVdata->eos_type == 2) {
+    // Centered difference on the beta-equilibrium table
+    const CCTK_REAL d = 1.0e-4;
+    const CCTK_REAL P_p = ghl_tabulated_compute_P_from_rho(TOVdata->ghl_eos, rho_baryon * (1.0 + d));
+    const CCTK_REAL P_m = ghl_tabulated_compute_P_from_rho(TOVdata->ghl_eos, rho_baryon * (1.0 - d));
+    return log(P_p / P_m) / log((1.0 + d) / (1.0 - d));
+  }
+  CCTK_REAL aK, aGamma;
+  ghl_hybrid_get_K_and_Gamma(TOVdata->ghl_eos, rho_baryon, &aK, &aGamma);
+  return aGamma;
+}
+
+/* (e+P) de/dP = (e+P)^2/(Gamma P) of the cold EOS at the current state, by the cold first law; zero outside the star.
+   Finite at the surface for Gamma <= 2; for Gamma > 2 it grows as P^(2/Gamma-1), which is integrable but unbounded. */
+static inline CCTK_REAL TOVola_enthalpy_dedP(const TOVola_data_struct *TOVdata, const CCTK_REAL rho_energy, const CCTK_REAL P) {
+  if (!(P > 0)) return 0.0;
+  return (rho_energy + P) * (rho_energy + P) / (TOVola_Gamma_eff(TOVdata, TOVdata->rho_baryon) * P);
+}
+
+/* Right-hand side of the observables. With j = exp(-nu/2) sqrt(1-2m/r), the slow-rotation frame dragging obeys
+   (r^4 j omega-bar')' = -4 r^3 j' omega-bar, and the even-parity l=2 static tidal field the Riccati equation for y = r H'/H.
+   nu is not yet matched to the exterior, so j is off by a constant factor, which cancels in omega-bar and is restored at the surface. */
+static inline void TOVola_observables_rhs(const CCTK_REAL r, const CCTK_REAL y[], const CCTK_REAL rho_energy, const TOVola_data_struct *TOVdata,
+                                   const CCTK_REAL dnudr, CCTK_REAL dydr[]) {
+  const CCTK_REAL P = y[TOVOLA_PRESSURE] > 0 ? y[TOVOLA_PRESSURE] : 0.0;
+  const CCTK_REAL rho_baryon = isnan(TOVdata->rho_baryon) ? 0.0 : TOVdata->rho_baryon;
+  const CCTK_REAL exp_lambda = 1.0 / (1.0 - 2.0 * y[TOVOLA_MASS] / r);
+  const CCTK_REAL j = exp(-0.5 * y[TOVOLA_NU]) / sqrt(exp_lambda);
+  const CCTK_REAL r2 = r * r;
+  const CCTK_REAL Y = y[TOVOLA_TIDAL_Y];
+  dydr[TOVOLA_BARYON_MASS] = 4.0 * M_PI * r2 * rho_baryon * sqrt(exp_lambda);
+  dydr[TOVOLA_OMEGA] = y[TOVOLA_OMEGA_FLUX] / (r2 * r2 * j);
+  dydr[TOVOLA_OMEGA_FLUX] = 16.0 * M_PI * r2 * r2 * (rho_energy + P) * exp_lambda * j * y[TOVOLA_OMEGA];
+  const CCTK_REAL Q = 4.0 * M_PI * exp_lambda * (5.0 * rho_energy + 9.0 * P + TOVola_enthalpy_dedP(TOVdata, rho_energy, P)) - 6.0 * exp_lambda / r2
+                      - dnudr * dnudr;
+  dydr[TOVOLA_TIDAL_Y] = -(Y * Y + Y * exp_lambda * (1.0 + 4.0 * M_PI * r2 * (P - rho_energy)) + r2 * Q) / r;
+}
+
+/* Initial observables: regular at the center, with omega-bar normalized to 1 there and y = 2 for l = 2 */
+static inline void TOVola_get_initial_observables(CCTK_REAL y[]) {
+  y[TOVOLA_BARYON_MASS] = 0.0;
+  y[TOVOLA_OMEGA] = 1.0;
+  y[TOVOLA_OMEGA_FLUX] = 0.0;
+  y[TOVOLA_TIDAL_Y] = 2.0;
+}
+
+/* Right-hand side of the sensitivity equations, the TOV equations varied with respect to rho_c. The pressure perturbation is
+   carried as delta(H) = delta(P)/(e+P), which stays finite at the surface where P, e and delta(P) all vanish.
+   delta(M)' = 4 pi r^2 (e+P) de/dP delta(H) does not for Gamma > 2, so delta(M) is integrated by parts near the surface. With the
+   displacement xi = -delta(P)/P' = delta(H) r(r-2M)/(M+4 pi r^3 P), delta(e) = -e' xi, and with the weight w = 1 - P/P_c the carried
+   variable mu = delta(M) + w 4 pi r^2 e xi obeys
+     mu' = 4 pi r^2 (e+P) delta(H) ((e+P)/Gamma + e)/P_c + w e (4 pi r^2 xi)',
+   which is bounded everywhere. w vanishes as r^2 at the center, where xi ~ 1/r, and mu = delta(M) at the surface, where e = 0. */
+static inline void TOVola_sensitivity_rhs(const CCTK_REAL r, const CCTK_REAL y[], const CCTK_REAL rho_energy, const TOVola_data_struct *TOVdata,
+                                   CCTK_REAL dydr[]) {
+  const int s = TOVdata->sensitivity_index;
+  const CCTK_REAL P = y[TOVOLA_PRESSURE] > 0 ? y[TOVOLA_PRESSURE] : 0.0;
+  const CCTK_REAL P_c = TOVdata->central_pressure;
+  const CCTK_REAL M = y[TOVOLA_MASS];
+  const CCTK_REAL enthalpy = rho_energy + P;
+  const CCTK_REAL dH = y[s + TOVOLA_DENTHALPY];
+  const CCTK_REAL r2M = r * (r - 2.0 * M);
+  const CCTK_REAL D = M + 4.0 * M_PI * r * r * r * P;
+  const CCTK_REAL g = r2M / D; // xi = g delta(H)
+  const CCTK_REAL xi = g * dH;
+  const CCTK_REAL w = 1.0 - P / P_c;
+  const CCTK_REAL dM = y[s + TOVOLA_DMASS] - w * 4.0 * M_PI * r * r * rho_energy * xi;
+  dydr[s + TOVOLA_DENTHALPY] = -(dM + 4.0 * M_PI * r * r * r * enthalpy * dH) / r2M - 2.0 * D * dM / (r2M * (r - 2.0 * M));
+
+  // (4 pi r^2 xi)', from the TOV right-hand side already in dydr
+  const CCTK_REAL dDdr = dydr[TOVOLA_MASS] + 12.0 * M_PI * r * r * P + 4.0 * M_PI * r * r * r * dydr[TOVOLA_PRESSURE];
+  const CCTK_REAL dgdr = ((2.0 * r - 2.0 * M - 2.0 * r * dydr[TOVOLA_MASS]) * D - r2M * dDdr) / (D * D);
+  const CCTK_REAL dxidr = g * dydr[s + TOVOLA_DENTHALPY] + dgdr * dH;
+  // The product (e+P) de/dP P is bounded even where the first factor is not
+  dydr[s + TOVOLA_DMASS] = 4.0 * M_PI * r * r * (TOVola_enthalpy_dedP(TOVdata, rho_energy, P) * P + rho_energy * enthalpy) * dH / P_c
+                           + w * rho_energy * 4.0 * M_PI * (2.0 * r * xi + r * r * dxidr);
+}
+
+/* Initial sensitivities: delta(P_c) = Gamma P_c / rho_c, and the mass vanishes at the center for any rho_c */
+static inline void TOVola_get_initial_sensitivities(CCTK_REAL y[], TOVola_data_struct *TOVdata) {
+  const int s = TOVdata->sensitivity_index;
+  TOVdata->central_pressure = y[TOVOLA_PRESSURE];
+  const CCTK_REAL rhoC_baryon = TOVdata->central_baryon_density;
+  const CCTK_REAL dPc = TOVola_Gamma_eff(TOVdata, rhoC_baryon) * y[TOVOLA_PRESSURE] / rhoC_baryon;
+  y[s + TOVOLA_DMASS] = 0.0;
+  y[s + TOVOLA_DENTHALPY] = dPc / (TOVdata->rho_energy + y[TOVOLA_PRESSURE]);
+}
+
 /* The main ODE function for GSL */
-static int TOVola_ODE(CCTK_REAL r_Schw, const CCTK_REAL y[], CCTK_REAL dydr_Schw[], void *params) {
+static inline int TOVola_ODE(CCTK_REAL r_Schw, const CCTK_REAL y[], CCTK_REAL dydr_Schw[], void *params) {
   // Cast params to TOVdata_struct
   TOVola_data_struct *TOVdata = (TOVola_data_struct *)params;
+  TOVdata->num_rhs_evaluations++;
 
   // Evaluate rho_baryon and rho_energy based on current state
   TOVola_evaluate_rho_and_eps(r_Schw, y, TOVdata);
@@ -148,6 +283,7 @@ static int TOVola_ODE(CCTK_REAL r_Schw, const CCTK_REAL y[], CCTK_REAL dydr_Schw
     dydr_Schw[TOVOLA_NU] = 0.0;       // dnu/dr
     dydr_Schw[TOVOLA_MASS] = 0.0;     // dM/dr
     dydr_Schw[TOVOLA_R_ISO] = 1.0;    // dr_iso/dr
+    for (int i = ODE_SOLVER_DIM; i < (int)TOVdata->system.dimension; i++) dydr_Schw[i] = 0.0; // Observables and sensitivities
     return GSL_SUCCESS;
   }
 
@@ -160,6 +296,8 @@ static int TOVola_ODE(CCTK_REAL r_Schw, const CCTK_REAL y[], CCTK_REAL dydr_Schw
     dydr_Schw[TOVOLA_NU] = ((mass_term) + 8.0 * M_PI * r_Schw * r_Schw * y[TOVOLA_PRESSURE]) / (r_Schw * denominator); //dnu/dr
     dydr_Schw[TOVOLA_MASS] = 4.0 * M_PI * r_Schw * r_Schw * rho_energy; // dM/dr
     dydr_Schw[TOVOLA_R_ISO] = y[TOVOLA_R_ISO] / (r_Schw * sqrt(1.0 - mass_term)); // dr_iso/dr (r_iso = isotropic radius, also known as rbar in literature)
+    if (TOVdata->observables) TOVola_observables_rhs(r_Schw, y, rho_energy, TOVdata, dydr_Schw[TOVOLA_NU], dydr_Schw);
+    if (TOVdata->sensitivities) TOVola_sensitivity_rhs(r_Schw, y, rho_energy, TOVdata, dydr_Schw);
   }
 	 
   //Adjust Length Scale. 
@@ -170,15 +308,36 @@ static int TOVola_ODE(CCTK_REAL r_Schw, const CCTK_REAL y[], CCTK_REAL dydr_Schw
   return GSL_SUCCESS;
 }
 
+/* Record the ODE right-hand side at an accepted sample, for Hermite interpolation */
+static inline void TOVola_store_derivatives(CCTK_REAL r_Schw, const CCTK_REAL y[], TOVola_data_struct *TOVdata, const int idx) {
+  // TOVola_ODE also updates the step-size scale, the EOS state and the evaluation count; keep the integration path and the
+  // reported cost exactly as without this call.
+  const CCTK_REAL r_lengthscale = TOVdata->r_lengthscale;
+  const CCTK_REAL rho_baryon = TOVdata->rho_baryon;
+  const CCTK_REAL rho_energy = TOVdata->rho_energy;
+  const long num_rhs_evaluations = TOVdata->num_rhs_evaluations;
+  CCTK_REAL dydr_Schw[ODE_SOLVER_MAX_DIM];
+  TOVola_ODE(r_Schw, y, dydr_Schw, TOVdata);
+  TOVdata->num_rhs_evaluations = num_rhs_evaluations;
+  TOVdata->r_lengthscale = r_lengthscale;
+  TOVdata->rho_baryon = rho_baryon;
+  TOVdata->rho_energy = rho_energy;
+
+  TOVdata->dPdr_arr[idx] = dydr_Schw[TOVOLA_PRESSURE];
+  TOVdata->dnudr_arr[idx] = dydr_Schw[TOVOLA_NU];
+  TOVdata->dMdr_arr[idx] = dydr_Schw[TOVOLA_MASS];
+  TOVdata->dIso_rdr_arr[idx] = dydr_Schw[TOVOLA_R_ISO];
+}
+
 /* Placeholder Jacobian function required by GSL */
-static int TOVola_jacobian_placeholder(CCTK_REAL t, const CCTK_REAL y[], CCTK_REAL *restrict dfdy, CCTK_REAL dfdt[], void *params) {
+static inline int TOVola_jacobian_placeholder(CCTK_REAL t, const CCTK_REAL y[], CCTK_REAL *restrict dfdy, CCTK_REAL dfdt[], void *params) {
   // Jacobian is not necessary for the TOV solution, but GSL requires some
   // function. Leave it empty as it does not affect the final results
   return GSL_SUCCESS;
 }
 
 /* Initialize the ODE variables */
-static void TOVola_get_initial_condition(CCTK_REAL y[], TOVola_data_struct *TOVdata) {
+static inline void TOVola_get_initial_condition(CCTK_REAL y[], TOVola_data_struct *TOVdata) {
   
   // Simple Polytrope
   if (TOVdata->eos_type == 0) {
@@ -232,11 +391,12 @@ static void TOVola_get_initial_condition(CCTK_REAL y[], TOVola_data_struct *TOVd
     TOVdata->rho_energy = (TOVdata->rho_baryon)*(1.0+eps);
   }
 
-  CCTK_VINFO("Initial Conditions Set: P = %.6e, nu = %.6e, M = %.6e, r_iso = %.6e", y[TOVOLA_PRESSURE], y[TOVOLA_NU], y[TOVOLA_MASS], y[TOVOLA_R_ISO]);
+  if (TOVdata->verbose)
+    CCTK_VINFO("Initial Conditions Set: P = %.6e, nu = %.6e, M = %.6e, r_iso = %.6e", y[TOVOLA_PRESSURE], y[TOVOLA_NU], y[TOVOLA_MASS], y[TOVOLA_R_ISO]);
 }
 
 /* Assign constants after each integration step */
-static void TOVola_assign_constants(CCTK_REAL c[], TOVola_data_struct *TOVdata) {
+static inline void TOVola_assign_constants(CCTK_REAL c[], TOVola_data_struct *TOVdata) {
   // Assign the densities
   c[0] = TOVdata->rho_energy; // Total energy density
   c[1] = TOVdata->rho_baryon; // Baryon density
@@ -248,12 +408,12 @@ static void TOVola_assign_constants(CCTK_REAL c[], TOVola_data_struct *TOVdata)
 }
 
 /* Function to set up the GSL ODE system and driver */
-static int setup_ode_system(const char *ode_method, gsl_odeiv2_system *system, gsl_odeiv2_driver **driver, TOVola_data_struct *TOVdata) {
+static inline int setup_ode_system(const char *ode_method, gsl_odeiv2_system *system, gsl_odeiv2_driver **driver, TOVola_data_struct *TOVdata) {
   
 
   system->function = TOVola_ODE;
   system->jacobian = TOVola_jacobian_placeholder;
-  system->dimension = 4; // Hardcoded as per requirements
+  system->dimension = TOVdata->sensitivity_index + (TOVdata->sensitivities ? TOVOLA_NUM_SENSITIVITIES : 0);
   system->params = TOVdata;
 
   if (CCTK_EQUALS(ode_method, "ARKF")) {
@@ -279,25 +439,40 @@ static int setup_ode_system(const char *ode_method, gsl_odeiv2_system *system, g
   return 0;
 }
 
-/* Initialize TOVola_data_struct structure with initial allocation */
-static int initialize_tovola_data(TOVola_data_struct *TOVdata) {
-  TOVdata->rSchw_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * TOVdata->numels_alloced_TOV_arr);
-  TOVdata->rho_energy_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * TOVdata->numels_alloced_TOV_arr);
-  TOVdata->rho_baryon_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * TOVdata->numels_alloced_TOV_arr);
-  TOVdata->P_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * TOVdata->numels_alloced_TOV_arr);
-  TOVdata->M_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * TOVdata->numels_alloced_TOV_arr);
-  TOVdata->nu_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * TOVdata->numels_alloced_TOV_arr);
-  TOVdata->Iso_r_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * TOVdata->numels_alloced_TOV_arr);
-  if (!TOVdata->rSchw_arr || !TOVdata->rho_energy_arr || !TOVdata->rho_baryon_arr || !TOVdata->P_arr || !TOVdata->M_arr || !TOVdata->nu_arr ||
-      !TOVdata->Iso_r_arr) {
-    CCTK_ERROR("Memory allocation failed for TOVola_data_struct.");
-    return -1;
+/* Make room for n samples in the TOVdata arrays. Capacity only grows, by at least half of it each time, and is kept between
+   integrations of the same TOVdata; realloc of the initial NULL arrays allocates them. */
+static inline void TOVola_reserve(TOVola_data_struct *TOVdata, const int n) {
+  const int grow = n > TOVdata->numels_alloced_TOV_arr;
+  if (grow) {
+    int new_arr_size = TOVdata->numels_alloced_TOV_arr > 0 ? 1.5 * TOVdata->numels_alloced_TOV_arr : 1024;
+    if (new_arr_size < n) new_arr_size = n;
+    TOVdata->numels_alloced_TOV_arr = new_arr_size;
+    TOVdata->rSchw_arr = realloc(TOVdata->rSchw_arr, sizeof(CCTK_REAL) * new_arr_size);
+    TOVdata->rho_energy_arr = realloc(TOVdata->rho_energy_arr, sizeof(CCTK_REAL) * new_arr_size);
+    TOVdata->rho_baryon_arr = realloc(TOVdata->rho_baryon_arr, sizeof(CCTK_REAL) * new_arr_size);
+    TOVdata->P_arr = realloc(TOVdata->P_arr, sizeof(CCTK_REAL) * new_arr_size);
+    TOVdata->M_arr = realloc(TOVdata->M_arr, sizeof(CCTK_REAL) * new_arr_size);
+    TOVdata->nu_arr = realloc(TOVdata->nu_arr, sizeof(CCTK_REAL) * new_arr_size);
+    TOVdata->Iso_r_arr = realloc(TOVdata->Iso_r_arr, sizeof(CCTK_REAL) * new_arr_size);
+    if (!TOVdata->rSchw_arr || !TOVdata->rho_energy_arr || !TOVdata->rho_baryon_arr || !TOVdata->P_arr || !TOVdata->M_arr || !TOVdata->nu_arr ||
+        !TOVdata->Iso_r_arr) {
+      CCTK_ERROR("Memory allocation failed for TOVola_data_struct.");
+    }
+  }
+  if (TOVdata->store_derivatives && (grow || !TOVdata->dPdr_arr)) {
+    const int size = TOVdata->numels_alloced_TOV_arr;
+    TOVdata->dPdr_arr = realloc(TOVdata->dPdr_arr, sizeof(CCTK_REAL) * size);
+    TOVdata->dnudr_arr = realloc(TOVdata->dnudr_arr, sizeof(CCTK_REAL) * size);
+    TOVdata->dMdr_arr = realloc(TOVdata->dMdr_arr, sizeof(CCTK_REAL) * size);
+    TOVdata->dIso_rdr_arr = realloc(TOVdata->dIso_rdr_arr, sizeof(CCTK_REAL) * size);
+    if (!TOVdata->dPdr_arr || !TOVdata->dnudr_arr || !TOVdata->dMdr_arr || !TOVdata->dIso_rdr_arr) {
+      CCTK_ERROR("Memory allocation failed for TOVola_data_struct derivatives.");
+    }
   }
-  return 0;
 }
 
 /* Free TOVola_data_struct structure */
-static void free_tovola_data(TOVola_data_struct *TOVdata) {
+static inline void free_tovola_data(TOVola_data_struct *TOVdata) {
   free(TOVdata->rSchw_arr);
   free(TOVdata->rho_energy_arr);
   free(TOVdata->rho_baryon_arr);
@@ -305,10 +480,199 @@ static void free_tovola_data(TOVola_data_struct *TOVdata) {
   free(TOVdata->M_arr);
   free(TOVdata->nu_arr);
   free(TOVdata->Iso_r_arr);
+  free(TOVdata->dPdr_arr);
+  free(TOVdata->dnudr_arr);
+  free(TOVdata->dMdr_arr);
+  free(TOVdata->dIso_rdr_arr);
+  TOVdata->rSchw_arr = TOVdata->rho_energy_arr = TOVdata->rho_baryon_arr = TOVdata->P_arr = TOVdata->M_arr = TOVdata->nu_arr = TOVdata->Iso_r_arr = NULL;
+  TOVdata->dPdr_arr = TOVdata->dnudr_arr = TOVdata->dMdr_arr = TOVdata->dIso_rdr_arr = NULL;
   TOVdata->numels_alloced_TOV_arr = 0;
+  if (TOVdata->driver) gsl_odeiv2_driver_free(TOVdata->driver);
+  TOVdata->driver = NULL;
 }
 
-static void free_ID_persist_data(TOVola_ID_persist_struct *TOVola_ID_persist) {
+/* Fill the parameters of TOVdata from the parfile, for one star of central density central_baryon_density.
+   This creates a solver context: no memory is allocated until the first integration, and the arrays and the GSL driver are then
+   kept and reused by every later integration of the same TOVdata (for a new star, only central_baryon_density changes),
+   until free_tovola_data. */
+static inline void TOVola_set_solver_parameters(TOVola_data_struct *TOVdata, const int eos_type, const CCTK_REAL central_baryon_density) {
+  DECLARE_CCTK_PARAMETERS;
+  TOVdata->eos_type = eos_type;
+  TOVdata->numpoints_actually_saved = 0;
+  TOVdata->num_rhs_evaluations = 0;
+  TOVdata->error_limit = TOVola_error_limit;
+  TOVdata->initial_ode_step_size = TOVola_initial_ode_step_size;
+  TOVdata->absolute_max_step = TOVola_absolute_max_step;
+  TOVdata->absolute_min_step = TOVola_absolute_min_step;
+  TOVdata->central_baryon_density = central_baryon_density;
+  TOVdata->ghl_eos = ghl_eos;
+  TOVdata->store_derivatives = CCTK_EQUALS("Hermite", TOVola_interpolation_method);
+  TOVdata->verbose = 0;
+  TOVdata->numels_alloced_TOV_arr = 0;
+  TOVdata->rSchw_arr = TOVdata->rho_energy_arr = TOVdata->rho_baryon_arr = TOVdata->P_arr = TOVdata->M_arr = TOVdata->nu_arr = TOVdata->Iso_r_arr = NULL;
+  TOVdata->dPdr_arr = TOVdata->dnudr_arr = TOVdata->dMdr_arr = TOVdata->dIso_rdr_arr = NULL;
+  TOVdata->driver = NULL;
+  TOVdata->warm_start_lengthscale = 0.0;
+  TOVdata->observables = TOVola_observables;
+  TOVdata->baryon_mass = 0.0;
+  TOVdata->moment_of_inertia = 0.0;
+  TOVdata->love_k2 = 0.0;
+  TOVdata->sensitivities = TOVola_sensitivities;
+  TOVdata->sensitivity_index = ODE_SOLVER_DIM + (TOVdata->observables ? TOVOLA_NUM_OBSERVABLES : 0);
+  TOVdata->central_pressure = 0.0;
+  TOVdata->dmass_drho_c = 0.0;
+  TOVdata->dradius_drho_c = 0.0;
+}
+
+/* Integrate the TOV equations from the center to the surface, storing every accepted step in the TOVdata arrays.
+   All mutable solver state lives in TOVdata, so several stars can be integrated concurrently, each with its own TOVdata.
+   The caller sets the parameters of TOVdata (TOVola_set_solver_parameters) and frees it with free_tovola_data. Integrating the
+   same TOVdata again reuses its arrays and GSL driver; TOVdata must not be moved in between, as GSL keeps &TOVdata->system. */
+static inline void TOVola_integrate(TOVola_data_struct *TOVdata, const char *ode_method, const int max_steps) {
+  CCTK_REAL current_position = 0;
+
+  TOVdata->numpoints_actually_saved = 0;
+  TOVdata->num_rhs_evaluations = 0;
+  const CCTK_REAL first_lengthscale = TOVdata->warm_start_lengthscale > 0 ? TOVdata->warm_start_lengthscale : TOVdata->initial_ode_step_size;
+  if (!TOVdata->driver) {
+    if (setup_ode_system(ode_method, &TOVdata->system, &TOVdata->driver, TOVdata) != 0) {
+      CCTK_ERROR("Failed to set up ODE system.");
+    }
+  }
+  else {
+    // Start from the first sampling interval when warm-started, else exactly as a new driver would
+    gsl_odeiv2_driver_reset_hstart(TOVdata->driver, TOVdata->warm_start_lengthscale > 0 ? MIN(0.01 * first_lengthscale, TOVdata->absolute_max_step)
+                                                                                        : TOVdata->initial_ode_step_size);
+  }
+  gsl_odeiv2_driver *driver = TOVdata->driver;
+  
+  if (TOVdata->verbose) CCTK_INFO("Starting TOV Integration using GSL for TOVola...");
+  /* Initialize ODE variables */
+  CCTK_REAL TOVola_eq[ODE_SOLVER_MAX_DIM];
+  CCTK_REAL c[2];
+  TOVola_get_initial_condition(TOVola_eq, TOVdata);
+  if (TOVdata->observables) TOVola_get_initial_observables(TOVola_eq);
+  if (TOVdata->sensitivities) TOVola_get_initial_sensitivities(TOVola_eq, TOVdata);
+  TOVola_assign_constants(c, TOVdata);
+
+  /* Initial memory allocation; a TOVdata that was integrated before keeps its arrays */
+  TOVola_reserve(TOVdata, 1);
+
+  /* Integration loop */
+  TOVdata->r_lengthscale = first_lengthscale; // initialize dr to a crazy small value in double precision, unless warm-started.
+  for (int i = 0; i < max_steps; i++) {
+    CCTK_REAL dr = 0.01 * TOVdata->r_lengthscale;
+    if (TOVdata->rho_baryon < 0.05 * TOVdata->central_baryon_density) {
+      // To get a super-accurate mass, reduce the dr sampling near the surface of the star.
+      dr = 1e-6 * TOVdata->r_lengthscale;
+    }
+    /* Exception handling */
+    TOVola_exception_handler(current_position, TOVola_eq);
+
+    /* Apply ODE step */
+    int status = gsl_odeiv2_driver_apply(driver, &current_position, current_position + dr, TOVola_eq);
+    if (status != GSL_SUCCESS) {
+      CCTK_VINFO("GSL ODE solver failed with status %d.", status);
+      CCTK_ERROR("Shutting down due to error");
+    };
+
+    /* Post-step exception handling */
+    TOVola_exception_handler(current_position, TOVola_eq);
+
+    /* Evaluate densities */
+    TOVola_evaluate_rho_and_eps(current_position, TOVola_eq, TOVdata);
+    TOVola_assign_constants(c, TOVdata);
+
+    /* Grow the arrays if needed */
+    TOVola_reserve(TOVdata, TOVdata->numpoints_actually_saved + 1);
+
+    /* Store data */
+    TOVdata->rSchw_arr[TOVdata->numpoints_actually_saved] = current_position;
+    TOVdata->rho_energy_arr[TOVdata->numpoints_actually_saved] = c[0];
+    TOVdata->rho_baryon_arr[TOVdata->numpoints_actually_saved] = c[1];
+    TOVdata->P_arr[TOVdata->numpoints_actually_saved] = TOVola_eq[TOVOLA_PRESSURE];
+    TOVdata->M_arr[TOVdata->numpoints_actually_saved] = TOVola_eq[TOVOLA_MASS];
+    TOVdata->nu_arr[TOVdata->numpoints_actually_saved] = TOVola_eq[TOVOLA_NU];
+    TOVdata->Iso_r_arr[TOVdata->numpoints_actually_saved] = TOVola_eq[TOVOLA_R_ISO];
+    if (TOVdata->store_derivatives) {
+      TOVola_store_derivatives(current_position, TOVola_eq, TOVdata, TOVdata->numpoints_actually_saved);
+    }
+    TOVdata->numpoints_actually_saved++;
+
+    /* Termination condition */
+    if (TOVola_do_we_terminate(current_position, TOVola_eq, TOVdata)) {
+      if (TOVdata->verbose) CCTK_VINFO("Finished Integration at position %.6e with Mass %.14e", current_position, TOVola_eq[TOVOLA_MASS]);
+      break;
+    }
+  }
+
+  const CCTK_REAL R = current_position;
+  const CCTK_REAL M = TOVola_eq[TOVOLA_MASS];
+
+  /* Surface observables */
+  if (TOVdata->observables) {
+    TOVdata->baryon_mass = TOVola_eq[TOVOLA_BARYON_MASS];
+    // Angular momentum J = r^4 j omega-bar'/6 with the matched j, then I = J/Omega, Omega = omega-bar + 2J/r^3 outside
+    const CCTK_REAL J = exp(0.5 * (TOVola_eq[TOVOLA_NU] - log(1.0 - 2.0 * M / R))) * TOVola_eq[TOVOLA_OMEGA_FLUX] / 6.0;
+    TOVdata->moment_of_inertia = J / (TOVola_eq[TOVOLA_OMEGA] + 2.0 * J / (R * R * R));
+    // Love number k2 from y at the surface, less the jump of a nonzero surface energy density (Hinderer 2008, Damour & Nagar 2009)
+    const CCTK_REAL C = M / R;
+    const CCTK_REAL Y = TOVola_eq[TOVOLA_TIDAL_Y] - 4.0 * M_PI * R * R * R * c[0] / M;
+    const CCTK_REAL one_2C = 1.0 - 2.0 * C;
+    TOVdata->love_k2 = 1.6 * pow(C, 5) * one_2C * one_2C * (2.0 + 2.0 * C * (Y - 1.0) - Y)
+                       / (2.0 * C * (6.0 - 3.0 * Y + 3.0 * C * (5.0 * Y - 8.0))
+                          + 4.0 * C * C * C * (13.0 - 11.0 * Y + C * (3.0 * Y - 2.0) + 2.0 * C * C * (1.0 + Y))
+                          + 3.0 * one_2C * one_2C * (2.0 - Y + 2.0 * C * (Y - 1.0)) * log(one_2C));
+  }
+
+  /* Surface sensitivities: delta(M) is the carried mu, as e vanishes (or, for tabulated EOSs, is at the table floor), and the shift of the P=0 surface, delta(R) = -delta(P)/(dP/dr) = delta(H) R(R-2M)/M */
+  if (TOVdata->sensitivities) {
+    TOVdata->dmass_drho_c = TOVola_eq[TOVdata->sensitivity_index + TOVOLA_DMASS];
+    TOVdata->dradius_drho_c = TOVola_eq[TOVdata->sensitivity_index + TOVOLA_DENTHALPY] * R * (R - 2.0 * M) / M;
+  }
+
+  if (TOVdata->verbose) CCTK_INFO("ODE Solver using GSL for TOVola Shutting Down...");
+}
+
+/* Baryon mass M_b = int 4 pi r^2 rho_b / sqrt(1-2m/r) dr over the Schwarzschild radius, by the trapezoidal rule.
+   Samples that do not advance in r (such as a mirrored r<0 buffer) are skipped; the integrand vanishes at the center. */
+static inline CCTK_REAL TOVola_baryon_mass(const int n, const CCTK_REAL *restrict r_Schw, const CCTK_REAL *restrict rho_baryon, const CCTK_REAL *restrict M) {
+  CCTK_REAL M_b = 0.0, r_prev = 0.0, f_prev = 0.0;
+  for (int i = 0; i < n; i++) {
+    const CCTK_REAL r = r_Schw[i];
+    if (!(r > r_prev)) continue;
+    const CCTK_REAL f = 4.0 * M_PI * r * r * rho_baryon[i] / sqrt(1.0 - 2.0 * M[i] / r);
+    M_b += 0.5 * (f + f_prev) * (r - r_prev);
+    r_prev = r;
+    f_prev = f;
+  }
+  return M_b;
+}
+
+/* Integrate the star of central density central_baryon_density and record its surface quantities. TOVdata is set up by
+   the caller and may be reused for the next star; only the parameters of this star are changed. */
+static inline void TOVola_surface_solve(TOVola_data_struct *TOVdata, const CCTK_REAL central_baryon_density, TOVola_sequence_star_struct *restrict star) {
+  DECLARE_CCTK_PARAMETERS;
+  TOVdata->central_baryon_density = central_baryon_density;
+  TOVola_integrate(TOVdata, TOVola_ODE_method, TOVola_size);
+
+  const int surface = TOVdata->numpoints_actually_saved - 1;
+  const CCTK_REAL M = TOVdata->M_arr[surface];
+  const CCTK_REAL R = TOVdata->rSchw_arr[surface];
+  star->central_baryon_density = central_baryon_density;
+  star->mass = M;
+  star->baryon_mass = TOVdata->observables ? TOVdata->baryon_mass
+                                            : TOVola_baryon_mass(TOVdata->numpoints_actually_saved, TOVdata->rSchw_arr, TOVdata->rho_baryon_arr, TOVdata->M_arr);
+  star->radius_Schw = R;
+  star->radius_iso = 0.5 * (sqrt(R * (R - 2.0 * M)) + R - M); // Isotropic radius of the Schwarzschild exterior at R, as in the normalization
+  star->num_rhs_evaluations = TOVdata->num_rhs_evaluations;
+  star->dmass_drho_c = TOVdata->dmass_drho_c;
+  star->dradius_drho_c = TOVdata->dradius_drho_c;
+  star->moment_of_inertia = TOVdata->moment_of_inertia;
+  star->love_k2 = TOVdata->love_k2;
+}
+
+static inline void free_ID_persist_data(TOVola_ID_persist_struct *TOVola_ID_persist) {
   CCTK_INFO("Cleanup! Freeing Memory...");
   free(TOVola_ID_persist->r_Schw_arr);
   free(TOVola_ID_persist->rho_energy_arr);
@@ -318,17 +682,57 @@ static void free_ID_persist_data(TOVola_ID_persist_struct *TOVola_ID_persist) {
   free(TOVola_ID_persist->expnu_arr);
   free(TOVola_ID_persist->r_iso_arr);
   free(TOVola_ID_persist->exp4phi_arr);
+  free(TOVola_ID_persist->knots);
+  free(TOVola_ID_persist->stencil_arr);
+  free(TOVola_ID_persist->drho_energy_arr);
+  free(TOVola_ID_persist->drho_baryon_arr);
+  free(TOVola_ID_persist->dP_arr);
+  free(TOVola_ID_persist->dexpnu_arr);
+  free(TOVola_ID_persist->dexp4phi_arr);
+  free(TOVola_ID_persist->cheb.r_edges);
+  free(TOVola_ID_persist->cheb.order);
+  free(TOVola_ID_persist->cheb.coeffs);
   CCTK_INFO("Memory Freed!");
 }
 
 
+/* Allocate the n-point normalized profile arrays of TOVola_ID_persist, with no derivatives, fit or stencils yet.
+   Returns nonzero if an allocation failed. */
+static inline int TOVola_alloc_persist_profile(TOVola_ID_persist_struct *TOVola_ID_persist, const int n) {
+  TOVola_ID_persist->r_Schw_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * n);
+  TOVola_ID_persist->rho_energy_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * n);
+  TOVola_ID_persist->rho_baryon_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * n);
+  TOVola_ID_persist->P_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * n);
+  TOVola_ID_persist->M_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * n);
+  TOVola_ID_persist->expnu_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * n);
+  TOVola_ID_persist->exp4phi_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * n);
+  TOVola_ID_persist->r_iso_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * n);
+
+  TOVola_ID_persist->drho_energy_arr = NULL;
+  TOVola_ID_persist->drho_baryon_arr = NULL;
+  TOVola_ID_persist->dP_arr = NULL;
+  TOVola_ID_persist->dexpnu_arr = NULL;
+  TOVola_ID_persist->dexp4phi_arr = NULL;
+  TOVola_ID_persist->stencil_arr = NULL;
+  TOVola_ID_persist->knots = NULL;
+  memset(&TOVola_ID_persist->cheb, 0, sizeof(TOVola_ID_persist->cheb));
+  TOVola_ID_persist->interp_method = TOVOLA_INTERP_LAGRANGE;
+  TOVola_ID_persist->numpoints_arr = n;
+  TOVola_ID_persist->baryon_mass = 0.0;
+  TOVola_ID_persist->moment_of_inertia = 0.0;
+  TOVola_ID_persist->love_k2 = 0.0;
+
+  return !TOVola_ID_persist->r_Schw_arr || !TOVola_ID_persist->rho_energy_arr || !TOVola_ID_persist->rho_baryon_arr || !TOVola_ID_persist->P_arr ||
+         !TOVola_ID_persist->M_arr || !TOVola_ID_persist->expnu_arr || !TOVola_ID_persist->exp4phi_arr || !TOVola_ID_persist->r_iso_arr;
+}
+
 /* Normalize and set data */
-static void TOVola_Normalize_and_set_data_integrated(TOVola_data_struct *TOVdata, CCTK_REAL *restrict r_Schw, CCTK_REAL *restrict rho_energy,
+static inline void TOVola_Normalize_and_set_data_integrated(TOVola_data_struct *TOVdata, CCTK_REAL *restrict r_Schw, CCTK_REAL *restrict rho_energy,
                                               CCTK_REAL *restrict rho_baryon, CCTK_REAL *restrict P, CCTK_REAL *restrict M, CCTK_REAL *restrict expnu,
                                               CCTK_REAL *restrict exp4phi, CCTK_REAL *restrict r_iso) {
   
 	
-  CCTK_INFO("TOVola Normalizing raw TOV data...");
+  if (TOVdata->verbose) CCTK_INFO("TOVola Normalizing raw TOV data...");
 
   /* Check if there are enough points to normalize */
   if (TOVdata->numpoints_actually_saved < 2) {
@@ -360,20 +764,101 @@ static void TOVola_Normalize_and_set_data_integrated(TOVola_data_struct *TOVdata
     expnu[i] = exp(expnu[i] - nu_surface + log(1.0 - 2.0 * M_surface / R_Schw_surface));
     exp4phi[i] = (r_Schw[i] / r_iso[i]) * (r_Schw[i] / r_iso[i]);
   }
-  CCTK_INFO("Normalization of raw data complete!");
+  if (TOVdata->verbose) CCTK_INFO("Normalization of raw data complete!");
+}
+
+/* Convert the stored ODE derivatives into d/dr_iso of the normalized grid fields, for Hermite interpolation.
+   Must run after TOVola_Normalize_and_set_data_integrated, while the raw data are still available. */
+static inline int TOVola_set_derivatives(const TOVola_data_struct *TOVdata, TOVola_ID_persist_struct *TOVola_ID_persist) {
+  const int n = TOVdata->numpoints_actually_saved;
+  TOVola_ID_persist->drho_energy_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * n);
+  TOVola_ID_persist->drho_baryon_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * n);
+  TOVola_ID_persist->dP_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * n);
+  TOVola_ID_persist->dexpnu_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * n);
+  TOVola_ID_persist->dexp4phi_arr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * n);
+  if (!TOVola_ID_persist->drho_energy_arr || !TOVola_ID_persist->drho_baryon_arr || !TOVola_ID_persist->dP_arr || !TOVola_ID_persist->dexpnu_arr ||
+      !TOVola_ID_persist->dexp4phi_arr) {
+    return -1;
+  }
+
+  const CCTK_REAL *restrict r_Schw = TOVola_ID_persist->r_Schw_arr;
+  const CCTK_REAL *restrict r_iso = TOVola_ID_persist->r_iso_arr;
+  const CCTK_REAL *restrict rho_energy = TOVola_ID_persist->rho_energy_arr;
+  const CCTK_REAL *restrict rho_baryon = TOVola_ID_persist->rho_baryon_arr;
+  const CCTK_REAL *restrict P = TOVola_ID_persist->P_arr;
+  // r_iso was rescaled by a constant during normalization; so is dr_iso/dr.
+  const CCTK_REAL normalize = r_iso[n - 1] / TOVdata->Iso_r_arr[n - 1];
+
+  for (int i = 0; i < n; i++) {
+    const CCTK_REAL dr_Schw_dr_iso = 1.0 / (normalize * TOVdata->dIso_rdr_arr[i]);
+    TOVola_ID_persist->dP_arr[i] = TOVdata->dPdr_arr[i] * dr_Schw_dr_iso;
+    TOVola_ID_persist->dexpnu_arr[i] = TOVola_ID_persist->expnu_arr[i] * TOVdata->dnudr_arr[i] * dr_Schw_dr_iso;
+    // exp4phi = (r_Schw/r_iso)^2
+    const CCTK_REAL ratio = r_Schw[i] / r_iso[i];
+    TOVola_ID_persist->dexp4phi_arr[i] = 2.0 * ratio * (dr_Schw_dr_iso - ratio) / r_iso[i];
+
+    // Densities follow P through the EOS: analytically for polytropes (cold first law),
+    // by finite differences along the profile for tables and at the surface.
+    if (TOVdata->eos_type != 2 && P[i] > 0 && rho_baryon[i] > 0) {
+      CCTK_REAL aK, aGamma;
+      ghl_hybrid_get_K_and_Gamma(TOVdata->ghl_eos, rho_baryon[i], &aK, &aGamma);
+      TOVola_ID_persist->drho_baryon_arr[i] = rho_baryon[i] / (aGamma * P[i]) * TOVola_ID_persist->dP_arr[i];
+      TOVola_ID_persist->drho_energy_arr[i] = (rho_energy[i] + P[i]) / rho_baryon[i] * TOVola_ID_persist->drho_baryon_arr[i];
+    } else {
+      const int im = MAX(i - 1, 0);
+      const int ip = MIN(i + 1, n - 1);
+      TOVola_ID_persist->drho_baryon_arr[i] = (rho_baryon[ip] - rho_baryon[im]) / (r_iso[ip] - r_iso[im]);
+      TOVola_ID_persist->drho_energy_arr[i] = (rho_energy[ip] - rho_energy[im]) / (r_iso[ip] - r_iso[im]);
+    }
+  }
+  return 0;
 }
 
 /* Extend data to r<0, to ensure we can interpolate to r=0 */
-void extend_to_negative_r(CCTK_REAL *restrict arr, const CCTK_REAL parity, CCTK_REAL *restrict tmp, const TOVola_data_struct *restrict TOVdata) {
-  for(int i=0;i<NEGATIVE_R_INTERP_BUFFER; i++) tmp[i] = parity * arr[NEGATIVE_R_INTERP_BUFFER - i - 1];
-  for(int i=0;i<TOVdata->numpoints_actually_saved; i++) tmp[i+NEGATIVE_R_INTERP_BUFFER] = arr[i];
-  memcpy(arr, tmp, sizeof(CCTK_REAL) * (TOVdata->numpoints_actually_saved+NEGATIVE_R_INTERP_BUFFER));
+static inline void extend_to_negative_r(CCTK_REAL *restrict arr, const CCTK_REAL parity, const int n) {
+  memmove(&arr[NEGATIVE_R_INTERP_BUFFER], arr, sizeof(CCTK_REAL) * n);
+  for(int i=0;i<NEGATIVE_R_INTERP_BUFFER; i++) arr[i] = parity * arr[2*NEGATIVE_R_INTERP_BUFFER - i - 1];
 }
 
-//For timelevel population, from original TOVsolver in the toolkit.
-void TOVola_TOV_Copy(CCTK_INT size, CCTK_REAL *var_p, CCTK_REAL *var)
-{
+/* Data in the TOVdata arrays are stored at r=TOVdata->initial_ode_step_size > 0 up to the stellar surface.
+   However, we may need data at r=0, which would require extrapolation.
+   To prevent that, we copy NEGATIVE_R_INTERP_BUFFER data points from r>0 to r<0 so that we can always interpolate.
+   The arrays are shifted in place, within their (grown if needed) capacity. */
+static inline void TOVola_mirror_to_negative_r(TOVola_data_struct *TOVdata) {
+  const int n = TOVdata->numpoints_actually_saved;
+  TOVola_reserve(TOVdata, n + NEGATIVE_R_INTERP_BUFFER);
+  extend_to_negative_r(TOVdata->rSchw_arr, -1.0, n);
+  extend_to_negative_r(TOVdata->rho_energy_arr, +1.0, n);
+  extend_to_negative_r(TOVdata->rho_baryon_arr, +1.0, n);
+  extend_to_negative_r(TOVdata->P_arr, +1.0, n);
+  extend_to_negative_r(TOVdata->M_arr, +1.0, n);
+  extend_to_negative_r(TOVdata->nu_arr, +1.0, n);
+  extend_to_negative_r(TOVdata->Iso_r_arr, -1.0, n);
+  if (TOVdata->store_derivatives) {
+    // Derivatives have the opposite parity of their functions.
+    extend_to_negative_r(TOVdata->dPdr_arr, -1.0, n);
+    extend_to_negative_r(TOVdata->dnudr_arr, -1.0, n);
+    extend_to_negative_r(TOVdata->dMdr_arr, -1.0, n);
+    extend_to_negative_r(TOVdata->dIso_rdr_arr, +1.0, n);
+  }
+  TOVdata->numpoints_actually_saved += NEGATIVE_R_INTERP_BUFFER;
+}
+
+/* Sample the beta-equilibrium slice at temperature T for the composition grid functions.
+   Y_e comes from GRHayL's slice (set up by ghl_tabulated_compute_Ye_P_eps_of_rho_beq_constant_T), the entropy from one table call per density. */
+static inline int TOVola_set_beq_slice(const ghl_eos_parameters *restrict eos, const CCTK_REAL T, TOVola_beq_struct *restrict beq) {
+  beq->N_rho = eos->N_rho;
+  beq->logrho = eos->table_logrho;
+  beq->Ye_of_lr = eos->Ye_of_lr;
+  beq->T = T;
+  beq->S_of_lr = (CCTK_REAL *restrict)malloc(sizeof(CCTK_REAL) * eos->N_rho);
+  if (!beq->S_of_lr) {
+    return -1;
+  }
 #pragma omp parallel for
-    for(int i=0; i<size; i++)
-        var_p[i] = var[i];
+  for (int i = 0; i < eos->N_rho; i++) {
+    CCTK_REAL P, eps;
+    ghl_tabulated_compute_P_eps_S_from_T(eos, exp(eos->table_logrho[i]), eos->Ye_of_lr[i], T, &P, &eps, &beq->S_of_lr[i]);
+  }
+  return 0;
 }